@@ -10,23 +10,102 @@
 
 /*Max BGUI active objects*/
 #ifndef BGUI_MAX_GUI_OBJECTS
-#define BGUI_MAX_GUI_OBJECTS (0x06)
+#define BGUI_MAX_GUI_OBJECTS (0x0C)
 #endif
 
-struct GUIObject
+/*Max BGUI dirty (to be repainted) rectangles*/
+#ifndef BGUI_MAX_DIRTY_RECTS
+#define BGUI_MAX_DIRTY_RECTS (0x04)
+#endif
+
+/*BGUI console size (one console per session)*/
+#ifndef BGUI_CONSOLE_ROWS
+#define BGUI_CONSOLE_ROWS (0x06)
+#endif
+#ifndef BGUI_CONSOLE_COLUMNS
+#define BGUI_CONSOLE_COLUMNS (0x14)
+#endif
+
+/*Max BGUI numeric fields and field width (in characters)*/
+#ifndef BGUI_MAX_NUMBERS
+#define BGUI_MAX_NUMBERS (0x03)
+#endif
+#ifndef BGUI_NUMBER_WIDTH
+#define BGUI_NUMBER_WIDTH (0x0A)
+#endif
+
+/*BGUI object types*/
+#define TYPE_BUTTON  (0x00)
+#define TYPE_LABEL   (0x01)
+#define TYPE_CONSOLE (0x02)
+#define TYPE_NUMBER  (0x03)
+
+/*BGUI colours*/
+#define COLOUR_BACKGROUND  (0x0000)
+#define COLOUR_TEXT        (0xFFFF)
+#define COLOUR_BUTTON      (0x001F)
+#define COLOUR_BUTTON_DOWN (0x0010)
+
+struct GUIRect
 {
-   unsigned char id;
    unsigned int x;
-   unsigned char y;
+   unsigned int y;
    unsigned int xEnd;
    unsigned int yEnd;
 };
 
+struct GUINumber
+{
+   const char *name;
+   unsigned char nameWidth;
+   unsigned char width;
+   unsigned char decimals;
+   char text[BGUI_NUMBER_WIDTH + 0x01];
+};
+
+struct GUIObject
+{
+   unsigned char id;
+   unsigned char type;
+   bool down;
+   const char *text;
+   const unsigned char *icon;
+   struct GUIRect rect;
+};
+
+static void invalidateRect(struct GUIRect);
+static bool isOverlapping(const struct GUIRect *restrict,
+                          const struct GUIRect *restrict);
+static void unionRect(struct GUIRect *restrict,
+                      const struct GUIRect *restrict);
+static unsigned long areaRect(const struct GUIRect *restrict);
+static void drawObject(const struct GUIObject *restrict,
+                       const struct GUIRect *restrict);
+static void drawText(const unsigned int, const unsigned char,
+                     const char *restrict, const unsigned int);
+static void invalidateConsoleRow(const unsigned char);
+static void drawNumber(const struct GUIObject *restrict,
+                       const struct GUIRect *restrict);
+static void formatNumber(char *restrict, long, const unsigned char,
+                         const unsigned char);
+static struct GUINumber *findNumber(const struct GUIObject *restrict);
+static struct GUIObject *findObject(const unsigned char);
+
 /*Static library (global/one session) variables*/
 static void (*eventHandler)(unsigned char, unsigned char);
 static unsigned char objectCount;
 static struct GUIObject objects[BGUI_MAX_GUI_OBJECTS];
 static unsigned char activeObject;
+static unsigned char dirtyCount;
+static struct GUIRect dirty[BGUI_MAX_DIRTY_RECTS];
+static struct
+{
+   struct GUIObject *obj;
+   unsigned char rows;
+   unsigned char head;
+   char text[BGUI_CONSOLE_ROWS][BGUI_CONSOLE_COLUMNS + 0x01];
+} console;
+static struct GUINumber numbers[BGUI_MAX_NUMBERS];
 
 
 /* Open default BGUI session.
@@ -39,6 +118,13 @@ bool BGUI_Open(void (*cb)(unsigned char, unsigned char))
 {
    eventHandler = cb;
    objectCount = 0x00;
+   activeObject = BGUI_MAX_GUI_OBJECTS;
+   dirtyCount = 0x00;
+   console.obj = NULL;
+   memset(numbers, 0x00, sizeof(numbers));
+
+   /*Whole screen is painted on first render*/
+   BGUI_Invalidate(0x00, 0x00, 0x0140, 0xF0);
    return false;
 }
 
@@ -64,42 +150,399 @@ void BGUI_Close(void)
  *         height - height of button
  *         id - id of button
  *
- * OUTPUT: [None]
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
  */
 bool BGUI_CreateButton(const char *restrict name, unsigned int x,
                        unsigned char y, const unsigned int width,
                        const unsigned char height, const unsigned char id)
 {
-   struct GUIObject obj;
+   struct GUIObject *obj;
 
-   /*TOOD: Round off corners of button*/
-   SSD1289_FillRect(x, y, width, height, 0x001F);
+   if(objectCount == BGUI_MAX_GUI_OBJECTS)
+   {
+      return true;
+   }
 
-   /*Write button name in center of button*/
-   x += ((width - (strlen(name) * SSD1289_FONT_WIDTH)) / 0x02);
-   y += ((height - SSD1289_FONT_HEIGHT) / 0x02);
-   SSD1289_WriteString(x, y, name, 0xFFFF, 0x001F);
+   /*Insert button into list (drawn on next render)*/
+   obj = &objects[objectCount++];
+   obj->id = id;
+   obj->type = TYPE_BUTTON;
+   obj->down = false;
+   obj->icon = NULL;
+   obj->text = name;
+   obj->rect.x = x;
+   obj->rect.y = y;
+   obj->rect.xEnd = (x + width);
+   obj->rect.yEnd = ((unsigned int)y + height);
+   invalidateRect(obj->rect);
+   return false;
+}
 
-   /*Insert button into list*/
-   obj.id = id;
-   obj.x = x;
-   obj.y = y;
-   obj.xEnd = (x + width);
-   obj.yEnd = ((unsigned int)y + height);
-   objects[objectCount++] = obj;
+
+/* Create a BGUI label (single line of text) object.
+ *
+ * INPUT : text - text of label
+ *         x - x-coordinate to place label
+ *         y - y-coordinate to place label
+ *         width - width of label (text is cleared to width)
+ *         id - id of label
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool BGUI_CreateLabel(const char *restrict text, unsigned int x,
+                      unsigned char y, const unsigned int width,
+                      const unsigned char id)
+{
+   struct GUIObject *obj;
+
+   if(objectCount == BGUI_MAX_GUI_OBJECTS)
+   {
+      return true;
+   }
+
+   obj = &objects[objectCount++];
+   obj->id = id;
+   obj->type = TYPE_LABEL;
+   obj->down = false;
+   obj->icon = NULL;
+   obj->text = text;
+   obj->rect.x = x;
+   obj->rect.y = y;
+   obj->rect.xEnd = (x + width);
+   obj->rect.yEnd = ((unsigned int)y + SSD1289_FONT_HEIGHT);
+   invalidateRect(obj->rect);
    return false;
 }
 
 
-/* Destroy/remove a BGUI button object.
+/* Set text of BGUI object (repainted on next render).
+ *
+ * INPUT : id - id of object
+ *         text - text to set (must remain valid while object exists)
+ *
+ * OUTPUT: [None]
+ */
+void BGUI_SetText(const unsigned char id, const char *restrict text)
+{
+   struct GUIObject *obj = findObject(id);
+
+   if((obj != NULL) &&
+      (obj->text != text))
+   {
+      obj->text = text;
+      invalidateRect(obj->rect);
+   }
+}
+
+
+/* Set icon of BGUI button (drawn instead of name, repainted on next render).
  *
  * INPUT : id - id of button
+ *         icon - RLE image in ROM (see SSD1289_DrawImage()), NULL for name
+ *
+ * OUTPUT: [None]
+ */
+void BGUI_SetIcon(const unsigned char id, const unsigned char *icon)
+{
+   struct GUIObject *obj = findObject(id);
+
+   if((obj != NULL) &&
+      (obj->icon != icon))
+   {
+      obj->icon = icon;
+      invalidateRect(obj->rect);
+   }
+}
+
+
+/* Create the BGUI console (scrolling log) object. Lines are written into a
+ * ring of rows in place (oldest line replaced, followed by a blank row), so
+ * each new line costs a single text line of repainting.
+ *
+ * INPUT : x - x-coordinate to place console
+ *         y - y-coordinate to place console
+ *         rows - number of rows (up to BGUI_CONSOLE_ROWS)
+ *         id - id of console
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool BGUI_CreateConsole(unsigned int x, unsigned char y,
+                        const unsigned char rows, const unsigned char id)
+{
+   struct GUIObject *obj;
+
+   if((objectCount == BGUI_MAX_GUI_OBJECTS) ||
+      (console.obj != NULL) ||
+      (rows < 0x02) ||
+      (rows > BGUI_CONSOLE_ROWS))
+   {
+      return true;
+   }
+
+   obj = &objects[objectCount++];
+   obj->id = id;
+   obj->type = TYPE_CONSOLE;
+   obj->down = false;
+   obj->icon = NULL;
+   obj->text = NULL;
+   obj->rect.x = x;
+   obj->rect.y = y;
+   obj->rect.xEnd = (x + (BGUI_CONSOLE_COLUMNS * SSD1289_FONT_WIDTH));
+   obj->rect.yEnd = ((unsigned int)y + (rows * SSD1289_FONT_HEIGHT));
+
+   console.obj = obj;
+   console.rows = rows;
+   console.head = 0x00;
+   memset(console.text, 0x00, sizeof(console.text));
+   invalidateRect(obj->rect);
+   return false;
+}
+
+
+/* Write line to BGUI console (repainted on next render).
+ *
+ * INPUT : text - line to write (truncated to BGUI_CONSOLE_COLUMNS)
+ *
+ * OUTPUT: [None]
+ */
+void BGUI_ConsoleWrite(const char *restrict text)
+{
+   if(console.obj == NULL)
+   {
+      return;
+   }
+
+   strncpy(console.text[console.head], text, BGUI_CONSOLE_COLUMNS);
+   invalidateConsoleRow(console.head);
+
+   /*Blank following (oldest) row to mark end of log*/
+   console.head = ((console.head + 0x01) % console.rows);
+   if(console.text[console.head][0x00] != '\0')
+   {
+      console.text[console.head][0x00] = '\0';
+      invalidateConsoleRow(console.head);
+   }
+}
+
+
+/* Create a BGUI numeric field (fixed-point, right aligned) object. Last set
+ * text is kept so only changed character cells are repainted.
+ *
+ * INPUT : name - name drawn before number (e.g. axis), must remain valid
+ *         x - x-coordinate to place field
+ *         y - y-coordinate to place field
+ *         width - width of number (in characters, up to BGUI_NUMBER_WIDTH)
+ *         decimals - number of decimal places
+ *         id - id of field
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool BGUI_CreateNumber(const char *restrict name, unsigned int x,
+                       unsigned char y, const unsigned char width,
+                       const unsigned char decimals, const unsigned char id)
+{
+   struct GUIObject *obj;
+   struct GUINumber *num;
+
+   num = findNumber(NULL);
+   if((objectCount == BGUI_MAX_GUI_OBJECTS) ||
+      (num == NULL) ||
+      (width == 0x00) ||
+      (width > BGUI_NUMBER_WIDTH) ||
+      (decimals >= width))
+   {
+      return true;
+   }
+
+   num->name = name;
+   num->nameWidth = strlen(name);
+   num->width = width;
+   num->decimals = decimals;
+   formatNumber(num->text, 0x00, width, decimals);
+
+   obj = &objects[objectCount++];
+   obj->id = id;
+   obj->type = TYPE_NUMBER;
+   obj->down = false;
+   obj->icon = NULL;
+   obj->text = num->text;
+   obj->rect.x = x;
+   obj->rect.y = y;
+   obj->rect.xEnd = (x + ((num->nameWidth + width) * SSD1289_FONT_WIDTH));
+   obj->rect.yEnd = ((unsigned int)y + SSD1289_FONT_HEIGHT);
+   invalidateRect(obj->rect);
+   return false;
+}
+
+
+/* Set value of BGUI numeric field (changed characters repainted on next
+ * render).
+ *
+ * INPUT : id - id of field
+ *         value - value (in units of last decimal place)
+ *
+ * OUTPUT: [None]
+ */
+void BGUI_SetNumber(const unsigned char id, const long value)
+{
+   struct GUIObject *obj = findObject(id);
+   struct GUINumber *num;
+   struct GUIRect rect;
+   char text[BGUI_NUMBER_WIDTH + 0x01];
+   unsigned char i;
+   unsigned char end;
+
+   if((obj == NULL) ||
+      (obj->type != TYPE_NUMBER))
+   {
+      return;
+   }
+
+   num = findNumber(obj);
+   formatNumber(text, value, num->width, num->decimals);
+
+   /*Invalidate each run of changed character cells*/
+   rect.y = obj->rect.y;
+   rect.yEnd = obj->rect.yEnd;
+   for(i = 0x00; i < num->width; i = end)
+   {
+      end = (i + 0x01);
+      if(text[i] == num->text[i])
+      {
+         continue;
+      }
+
+      while((end < num->width) &&
+            (text[end] != num->text[end]))
+      {
+         end++;
+      }
+
+      rect.x = (obj->rect.x + ((num->nameWidth + i) * SSD1289_FONT_WIDTH));
+      rect.xEnd = (obj->rect.x + ((num->nameWidth + end) *
+                                  SSD1289_FONT_WIDTH));
+      invalidateRect(rect);
+   }
+
+   memcpy(num->text, text, num->width);
+}
+
+
+/* Destroy/remove a BGUI object.
+ *
+ * INPUT : id - id of object
  *
  * OUTPUT: [None]
  */
 void BGUI_DestroyButton(unsigned char id)
 {
-   //TODO: remove (or mark) obj from list
+   struct GUIObject *obj = findObject(id);
+   unsigned char i;
+   unsigned char j;
+
+   if(obj == NULL)
+   {
+      return;
+   }
+
+   /*Remove object (preserving order) and repaint area it occupied*/
+   i = (unsigned char)(obj - objects);
+   invalidateRect(obj->rect);
+   if(obj->type == TYPE_NUMBER)
+   {
+      findNumber(obj)->width = 0x00;
+   }
+   objectCount--;
+   memmove(obj, obj + 0x01, (objectCount - i) * sizeof(*obj));
+
+   /*Console object may have moved (or been removed)*/
+   console.obj = NULL;
+   for(j = 0x00; j < objectCount; j++)
+   {
+      if(objects[j].type == TYPE_CONSOLE)
+      {
+         console.obj = &objects[j];
+      }
+   }
+
+   if(activeObject == i)
+   {
+      activeObject = BGUI_MAX_GUI_OBJECTS;
+   }
+   else if((activeObject > i) &&
+           (activeObject != BGUI_MAX_GUI_OBJECTS))
+   {
+      activeObject--;
+   }
+}
+
+
+/* Mark screen area to be repainted on next render.
+ *
+ * INPUT : x - x-coordinate of area
+ *         y - y-coordinate of area
+ *         width - width of area
+ *         height - height of area
+ *
+ * OUTPUT: [None]
+ */
+void BGUI_Invalidate(const unsigned int x, const unsigned char y,
+                     const unsigned int width, const unsigned char height)
+{
+   struct GUIRect rect;
+
+   rect.x = x;
+   rect.y = y;
+   rect.xEnd = (x + width);
+   rect.yEnd = ((unsigned int)y + height);
+   invalidateRect(rect);
+}
+
+
+/* Repaint dirty screen areas (in a single pass). Areas fully covered by an
+ * object are not cleared first, so object updates don't flicker.
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void BGUI_Render(void)
+{
+   unsigned char i;
+   unsigned char j;
+   bool covered;
+
+   for(i = 0x00; i < dirtyCount; i++)
+   {
+      covered = false;
+      for(j = 0x00; j < objectCount; j++)
+      {
+         if((objects[j].rect.x <= dirty[i].x) &&
+            (objects[j].rect.y <= dirty[i].y) &&
+            (objects[j].rect.xEnd >= dirty[i].xEnd) &&
+            (objects[j].rect.yEnd >= dirty[i].yEnd))
+         {
+            covered = true;
+            break;
+         }
+      }
+
+      if(!covered)
+      {
+         SSD1289_FillRect(dirty[i].x, dirty[i].y, dirty[i].xEnd - dirty[i].x,
+                          dirty[i].yEnd - dirty[i].y, COLOUR_BACKGROUND);
+      }
+
+      for(j = 0x00; j < objectCount; j++)
+      {
+         if(isOverlapping(&objects[j].rect, &dirty[i]))
+         {
+            drawObject(&objects[j], &dirty[i]);
+         }
+      }
+   }
+
+   dirtyCount = 0x00;
 }
 
 
@@ -117,11 +560,14 @@ void BGUI_Hit(const unsigned int x, const unsigned char y)
    /*Check all objects to determine which was hit (i.e. hit-testing)*/
    for(i = 0x00; i < objectCount; i++)
    {
-      if(((x >= objects[i].x) && (x <= objects[i].xEnd)) &&
-         ((y >= objects[i].y) && (y <= objects[i].yEnd)))
+      if((objects[i].type == TYPE_BUTTON) &&
+         ((x >= objects[i].rect.x) && (x < objects[i].rect.xEnd)) &&
+         ((y >= objects[i].rect.y) && (y < objects[i].rect.yEnd)))
       {
          /*Mark object as active and send button down event*/
          activeObject = i;
+         objects[i].down = true;
+         invalidateRect(objects[i].rect);
          eventHandler(objects[activeObject].id, BGUI_BTN_DOWN);
          break;
       }
@@ -137,6 +583,385 @@ void BGUI_Hit(const unsigned int x, const unsigned char y)
  */
 void BGUI_Release(void)
 {
+   if(activeObject == BGUI_MAX_GUI_OBJECTS)
+   {
+      return;
+   }
+
    /*Send button released event to active object*/
+   objects[activeObject].down = false;
+   invalidateRect(objects[activeObject].rect);
    eventHandler(objects[activeObject].id, BGUI_BTN_UP);
+   activeObject = BGUI_MAX_GUI_OBJECTS;
+}
+
+
+/* Add rectangle to dirty list, coalescing with overlapping (or touching)
+ * rectangles. If list is full, rectangle is merged with the dirty rectangle
+ * whose area grows least.
+ *
+ * INPUT : rect - rectangle to add
+ *
+ * OUTPUT: [None]
+ */
+void invalidateRect(struct GUIRect rect)
+{
+   struct GUIRect merged;
+   unsigned long growth;
+   unsigned long best;
+   unsigned char i;
+   unsigned char j;
+
+   while(0x01)
+   {
+      for(i = 0x00; i < dirtyCount; i++)
+      {
+         if(isOverlapping(&dirty[i], &rect))
+         {
+            break;
+         }
+      }
+
+      if(i == dirtyCount)
+      {
+         if(dirtyCount < BGUI_MAX_DIRTY_RECTS)
+         {
+            dirty[dirtyCount++] = rect;
+            return;
+         }
+
+         /*Find cheapest merge*/
+         best = 0xFFFFFFFFUL;
+         for(j = 0x00; j < dirtyCount; j++)
+         {
+            merged = dirty[j];
+            unionRect(&merged, &rect);
+            growth = (areaRect(&merged) - areaRect(&dirty[j]));
+            if(growth < best)
+            {
+               best = growth;
+               i = j;
+            }
+         }
+      }
+
+      /*Remove merged rectangle and re-check grown rectangle*/
+      unionRect(&rect, &dirty[i]);
+      dirty[i] = dirty[--dirtyCount];
+   }
+}
+
+
+/* Check if two rectangles overlap (or touch).
+ *
+ * INPUT : a - first rectangle
+ *         b - second rectangle
+ *
+ * OUTPUT: [Return] - true if rectangles overlap, false otherwise
+ */
+bool isOverlapping(const struct GUIRect *restrict a,
+                   const struct GUIRect *restrict b)
+{
+   return ((a->x <= b->xEnd) && (b->x <= a->xEnd) &&
+           (a->y <= b->yEnd) && (b->y <= a->yEnd));
+}
+
+
+/* Grow rectangle to bound another.
+ *
+ * INPUT : a - rectangle to grow
+ *         b - rectangle to bound
+ *
+ * OUTPUT: a - bounding rectangle
+ */
+void unionRect(struct GUIRect *restrict a, const struct GUIRect *restrict b)
+{
+   if(b->x < a->x)
+   {
+      a->x = b->x;
+   }
+   if(b->y < a->y)
+   {
+      a->y = b->y;
+   }
+   if(b->xEnd > a->xEnd)
+   {
+      a->xEnd = b->xEnd;
+   }
+   if(b->yEnd > a->yEnd)
+   {
+      a->yEnd = b->yEnd;
+   }
+}
+
+
+/* Calculate area of rectangle.
+ *
+ * INPUT : rect - rectangle
+ *
+ * OUTPUT: [Return] - area of rectangle
+ */
+unsigned long areaRect(const struct GUIRect *restrict rect)
+{
+   return ((unsigned long)(rect->xEnd - rect->x) * (rect->yEnd - rect->y));
+}
+
+
+/* Draw BGUI object.
+ *
+ * INPUT : obj - object to draw
+ *         clip - area being repainted (console only draws rows within)
+ *
+ * OUTPUT: [None]
+ */
+void drawObject(const struct GUIObject *restrict obj,
+                const struct GUIRect *restrict clip)
+{
+   unsigned int width = (obj->rect.xEnd - obj->rect.x);
+   unsigned char height = (obj->rect.yEnd - obj->rect.y);
+   unsigned int innerWidth;
+   unsigned char innerHeight;
+   unsigned int colour;
+   unsigned int y;
+   unsigned char i;
+
+   if(obj->type == TYPE_BUTTON)
+   {
+      /*TOOD: Round off corners of button*/
+      colour = ((obj->down) ? COLOUR_BUTTON_DOWN : COLOUR_BUTTON);
+      SSD1289_FillRect(obj->rect.x, obj->rect.y, width, height, colour);
+
+      /*Draw button icon (or name) in center of button*/
+      if(obj->icon != NULL)
+      {
+         SSD1289_GetImageSize(obj->icon, &innerWidth, &innerHeight);
+         SSD1289_DrawImage(obj->rect.x + ((width - innerWidth) / 0x02),
+                           obj->rect.y + ((height - innerHeight) / 0x02),
+                           obj->icon, colour);
+      }
+      else
+      {
+         innerWidth = (strlen(obj->text) * SSD1289_FONT_WIDTH);
+         SSD1289_WriteString(obj->rect.x + ((width - innerWidth) / 0x02),
+                             obj->rect.y + ((height - SSD1289_FONT_HEIGHT) /
+                                            0x02),
+                             obj->text, COLOUR_TEXT, colour);
+      }
+   }
+   else if(obj->type == TYPE_LABEL)
+   {
+      drawText(obj->rect.x, obj->rect.y, obj->text, width);
+   }
+   else if(obj->type == TYPE_NUMBER)
+   {
+      drawNumber(obj, clip);
+   }
+   else
+   {
+      for(i = 0x00; i < console.rows; i++)
+      {
+         y = (obj->rect.y + (i * SSD1289_FONT_HEIGHT));
+         if((y < clip->yEnd) &&
+            ((y + SSD1289_FONT_HEIGHT) > clip->y))
+         {
+            drawText(obj->rect.x, y, console.text[i], width);
+         }
+      }
+   }
+}
+
+
+/* Draw line of text, clearing remainder of line.
+ *
+ * INPUT : x - x-coordinate of text
+ *         y - y-coordinate of text
+ *         text - text to draw
+ *         width - width of line
+ *
+ * OUTPUT: [None]
+ */
+void drawText(const unsigned int x, const unsigned char y,
+              const char *restrict text, const unsigned int width)
+{
+   unsigned int textWidth = (strlen(text) * SSD1289_FONT_WIDTH);
+
+   if(textWidth)
+   {
+      SSD1289_WriteString(x, y, text, COLOUR_TEXT, COLOUR_BACKGROUND);
+   }
+   if(textWidth < width)
+   {
+      SSD1289_FillRect(x + textWidth, y, width - textWidth,
+                       SSD1289_FONT_HEIGHT, COLOUR_BACKGROUND);
+   }
+}
+
+
+/* Mark BGUI console row to be repainted on next render.
+ *
+ * INPUT : row - console row
+ *
+ * OUTPUT: [None]
+ */
+void invalidateConsoleRow(const unsigned char row)
+{
+   struct GUIRect rect = console.obj->rect;
+
+   rect.y += (row * SSD1289_FONT_HEIGHT);
+   rect.yEnd = (rect.y + SSD1289_FONT_HEIGHT);
+   invalidateRect(rect);
+}
+
+
+/* Draw character cells of BGUI numeric field within area being repainted
+ * (as a single string).
+ *
+ * INPUT : obj - numeric field to draw
+ *         clip - area being repainted
+ *
+ * OUTPUT: [None]
+ */
+void drawNumber(const struct GUIObject *restrict obj,
+                const struct GUIRect *restrict clip)
+{
+   const struct GUINumber *num = findNumber(obj);
+   char text[BGUI_NUMBER_WIDTH + 0x01];
+   unsigned char cells = (num->nameWidth + num->width);
+   unsigned char first = 0x00;
+   unsigned char last = cells;
+   unsigned char i;
+
+   /*Clip to cells (clip may only touch field)*/
+   if(clip->x > obj->rect.x)
+   {
+      first = ((clip->x - obj->rect.x) / SSD1289_FONT_WIDTH);
+   }
+   if(clip->xEnd < obj->rect.xEnd)
+   {
+      last = (((clip->xEnd - obj->rect.x) + (SSD1289_FONT_WIDTH - 0x01)) /
+              SSD1289_FONT_WIDTH);
+   }
+   if((first >= last) ||
+      (clip->y >= obj->rect.yEnd) ||
+      (clip->yEnd <= obj->rect.y))
+   {
+      return;
+   }
+
+   /*Name is drawn with (but separately from) number*/
+   if(first < num->nameWidth)
+   {
+      SSD1289_WriteString(obj->rect.x, obj->rect.y, num->name, COLOUR_TEXT,
+                          COLOUR_BACKGROUND);
+      first = num->nameWidth;
+   }
+
+   for(i = 0x00; first < last; i++, first++)
+   {
+      text[i] = num->text[first - num->nameWidth];
+   }
+   text[i] = '\0';
+
+   if(i)
+   {
+      SSD1289_WriteString(obj->rect.x + ((last - i) * SSD1289_FONT_WIDTH),
+                          obj->rect.y, text, COLOUR_TEXT, COLOUR_BACKGROUND);
+   }
+}
+
+
+/* Format fixed-point number right aligned to width (filled with '#' if it
+ * doesn't fit).
+ *
+ * INPUT : value - value (in units of last decimal place)
+ *         width - width of text
+ *         decimals - number of decimal places
+ *
+ * OUTPUT: text - formatted text (width + 1 in size)
+ */
+void formatNumber(char *restrict text, long value, const unsigned char width,
+                  const unsigned char decimals)
+{
+   char digits[(sizeof(long) * 0x03) + 0x03];
+   unsigned long magnitude = ((value < 0x00) ? (0x00UL - (unsigned long)value) :
+                                               (unsigned long)value);
+   unsigned char length = 0x00;
+   unsigned char i;
+
+   /*Digits in reverse (at least one integer digit)*/
+   do
+   {
+      if((decimals != 0x00) &&
+         (length == decimals))
+      {
+         digits[length++] = '.';
+      }
+
+      digits[length++] = ('0' + (magnitude % 0x0A));
+      magnitude /= 0x0A;
+   } while((magnitude) || (length <= decimals));
+
+   if(value < 0x00)
+   {
+      digits[length++] = '-';
+   }
+
+   text[width] = '\0';
+   if(length > width)
+   {
+      memset(text, '#', width);
+      return;
+   }
+
+   memset(text, ' ', width - length);
+   for(i = (width - length); length; i++)
+   {
+      text[i] = digits[--length];
+   }
+}
+
+
+/* Find BGUI numeric field state of object.
+ *
+ * INPUT : obj - numeric field object, NULL for a free state
+ *
+ * OUTPUT: [Return] - numeric field state, NULL if not found
+ */
+struct GUINumber *findNumber(const struct GUIObject *restrict obj)
+{
+   unsigned char i;
+
+   for(i = 0x00; i < BGUI_MAX_NUMBERS; i++)
+   {
+      if((obj == NULL) ?
+         (numbers[i].width == 0x00) :
+         (numbers[i].text == obj->text))
+      {
+         return &numbers[i];
+      }
+   }
+
+   return NULL;
+}
+
+
+/* Find BGUI object by id.
+ *
+ * INPUT : id - id of object
+ *
+ * OUTPUT: [Return] - object, NULL if not found
+ */
+struct GUIObject *findObject(const unsigned char id)
+{
+   unsigned char i;
+
+   for(i = 0x00; i < objectCount; i++)
+   {
+      if(objects[i].id == id)
+      {
+         return &objects[i];
+      }
+   }
+
+   return NULL;
 }
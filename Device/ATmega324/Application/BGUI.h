@@ -20,7 +20,21 @@ void BGUI_Close(void);
 bool BGUI_CreateButton(const char *restrict, unsigned int, unsigned char,
                        const unsigned int, const unsigned char,
                        const unsigned char);
+bool BGUI_CreateLabel(const char *restrict, unsigned int, unsigned char,
+                      const unsigned int, const unsigned char);
+void BGUI_SetText(const unsigned char, const char *restrict);
+void BGUI_SetIcon(const unsigned char, const unsigned char *);
+bool BGUI_CreateConsole(unsigned int, unsigned char, const unsigned char,
+                        const unsigned char);
+void BGUI_ConsoleWrite(const char *restrict);
+bool BGUI_CreateNumber(const char *restrict, unsigned int, unsigned char,
+                       const unsigned char, const unsigned char,
+                       const unsigned char);
+void BGUI_SetNumber(const unsigned char, const long);
 void BGUI_DestroyButton(const unsigned char);
+void BGUI_Invalidate(const unsigned int, const unsigned char,
+                     const unsigned int, const unsigned char);
+void BGUI_Render(void);
 void BGUI_Hit(const unsigned int, const unsigned char);
 void BGUI_Release(void);
 
@@ -5,8 +5,82 @@
 /*Description: Definitions for functions exported by the device bootloader.   */
 /******************************************************************************/
 #include <stdbool.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
 #include "BootExport.h"
 
+/*Export table layout (at fixed address in bootloader section)*/
+#define EXPORT_TABLE   (0x7FC0)
+#define EXPORT_MAGIC   (0xB0E7)
+#define EXPORT_VERSION (0x01)
+#define OFF_MAGIC      (0x00)
+#define OFF_VERSION    (0x02)
+#define OFF_COUNT      (0x03)
+#define OFF_BCP_SIZE   (0x04)
+#define OFF_ENTRIES    (0x06)
+
+/*Exported function (word) addresses, defaults are fixed jmp entries of
+  bootloaders predating export table*/
+static uint16_t exports[BOOTEXPORT_COUNT] = {0x3FF4, 0x3FF6, 0x3FF8, 0x3FFA,
+                                             0x3FFC, 0x3FFE};
+
+
+/* Read bootloader export table and resolve exported functions. Bootloaders
+ * without an export table provide the same entries at fixed addresses.
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [Return] - true if bootloader exports are incompatible (all entries
+ *                    are then unavailable), false otherwise
+ */
+bool BootExport_Open(void)
+{
+   unsigned char count;
+   unsigned char i;
+
+   /*Check for export table*/
+   if(pgm_read_word(EXPORT_TABLE + OFF_MAGIC) != EXPORT_MAGIC)
+   {
+      return false;
+   }
+
+   /*Check table layout and shared structure size match*/
+   if((pgm_read_byte(EXPORT_TABLE + OFF_VERSION) != EXPORT_VERSION) ||
+      (pgm_read_word(EXPORT_TABLE + OFF_BCP_SIZE) !=
+       sizeof(struct BCP_Session)))
+   {
+      for(i = 0x00; i < BOOTEXPORT_COUNT; i++)
+      {
+         exports[i] = 0x0000;
+      }
+
+      return true;
+   }
+
+   /*Resolve entries (newer bootloaders may export more than known here)*/
+   count = pgm_read_byte(EXPORT_TABLE + OFF_COUNT);
+   for(i = 0x00; i < BOOTEXPORT_COUNT; i++)
+   {
+      exports[i] = (i < count) ?
+                   pgm_read_word(EXPORT_TABLE + OFF_ENTRIES + (i * 0x02)) :
+                   0x0000;
+   }
+
+   return false;
+}
+
+
+/* Check if bootloader exports function.
+ *
+ * INPUT : entry - export table entry (BOOTEXPORT_*)
+ *
+ * OUTPUT: [Return] - true if function exported, false otherwise
+ */
+bool BootExport_HasEntry(unsigned char entry)
+{
+   return (entry < BOOTEXPORT_COUNT) && (exports[entry] != 0x0000);
+}
+
 
 /* Interrupt service routine for TWI module.
  *
@@ -16,7 +90,12 @@
  */
 void TWI_ISR(void)
 {
-   ((void (*)(void))0x3FF4)();
+   void (*fn)(void) = (void (*)(void))exports[BOOTEXPORT_TWI_ISR];
+
+   if(fn)
+   {
+      fn();
+   }
 }
 
 
@@ -29,7 +108,10 @@ void TWI_ISR(void)
  */
 bool TWI_Poll(unsigned char *remainder)
 {
-   return ((bool (*)(unsigned char *))0x3FF6)(remainder);
+   bool (*fn)(unsigned char *) =
+      (bool (*)(unsigned char *))exports[BOOTEXPORT_TWI_POLL];
+
+   return (fn) ? fn(remainder) : false;
 }
 
 
@@ -43,8 +125,11 @@ bool TWI_Poll(unsigned char *remainder)
  */
 bool TWI_StartWrite(unsigned char addr, unsigned char *buf, unsigned char size)
 {
-   return ((bool (*)(unsigned char, unsigned char *, unsigned char))0x3FF8)
-           (addr, buf, size);
+   bool (*fn)(unsigned char, unsigned char *, unsigned char) =
+      (bool (*)(unsigned char, unsigned char *, unsigned char))
+      exports[BOOTEXPORT_TWI_START_WRITE];
+
+   return (fn) ? fn(addr, buf, size) : false;
 }
 
 
@@ -58,8 +143,11 @@ bool TWI_StartWrite(unsigned char addr, unsigned char *buf, unsigned char size)
  */
 bool TWI_StartRead(unsigned char addr, unsigned char *buf, unsigned char size)
 {
-   return ((bool (*)(unsigned char, unsigned char *, unsigned char))0x3FFA)
-           (addr, buf, size);
+   bool (*fn)(unsigned char, unsigned char *, unsigned char) =
+      (bool (*)(unsigned char, unsigned char *, unsigned char))
+      exports[BOOTEXPORT_TWI_START_READ];
+
+   return (fn) ? fn(addr, buf, size) : false;
 }
 
 
@@ -71,7 +159,13 @@ bool TWI_StartRead(unsigned char addr, unsigned char *buf, unsigned char size)
  */
 void BCP_Open(struct BCP_Session *bcp)
 {
-   ((void (*)(struct BCP_Session *))0x3FFC)(bcp);
+   void (*fn)(struct BCP_Session *) =
+      (void (*)(struct BCP_Session *))exports[BOOTEXPORT_BCP_OPEN];
+
+   if(fn)
+   {
+      fn(bcp);
+   }
 }
 
 
@@ -87,8 +181,14 @@ bool BCP_HandleRequest(struct BCP_Session *restrict bcp,
                        bool (*rd)(unsigned long long, void *, unsigned char),
                        bool (*wr)(unsigned long long, void *, unsigned char))
 {
-   return ((bool (*)(struct BCP_Session *const,
-                     bool (*const)(unsigned long long, void *, unsigned char),
-                     bool (*const)(unsigned long long, void *,
-                                   unsigned char)))0x3FFE)(bcp, rd, wr);
+   bool (*fn)(struct BCP_Session *const,
+              bool (*const)(unsigned long long, void *, unsigned char),
+              bool (*const)(unsigned long long, void *, unsigned char)) =
+      (bool (*)(struct BCP_Session *const,
+                bool (*const)(unsigned long long, void *, unsigned char),
+                bool (*const)(unsigned long long, void *, unsigned char)))
+      exports[BOOTEXPORT_BCP_HANDLE_REQ];
+
+   return (fn) ? fn(bcp, rd, wr) : true;
 }
+
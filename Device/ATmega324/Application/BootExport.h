@@ -8,32 +8,34 @@
 #define BOOT_EXPORT_H
 #include <stdbool.h>
 #include "Platform.h"
+#include "BCP.h"
 
-/*Borrowed from BCP.h*/
-struct BCP_Session
-{
-   unsigned char pkt[0x0A];
-   unsigned char flags;
-   unsigned long long address;
-   bool (*read)(void *, unsigned char);
-   bool (*write)(void *, unsigned char);
-};
-
-/*Borrowed from TWI.h*/
+/*Bootloader export table entries*/
+#define BOOTEXPORT_TWI_ISR         (0x00)
+#define BOOTEXPORT_TWI_POLL        (0x01)
+#define BOOTEXPORT_TWI_START_WRITE (0x02)
+#define BOOTEXPORT_TWI_START_READ  (0x03)
+#define BOOTEXPORT_BCP_OPEN        (0x04)
+#define BOOTEXPORT_BCP_HANDLE_REQ  (0x05)
+#define BOOTEXPORT_COUNT           (0x06)
+
+/*Borrowed from TWI.h (bootloader owned registers)*/
+#if PLATFORM_ARCH == PLATFORM_AVR
 register uint8_t TWI_Flags    asm("r2");
 register uint8_t TWI_AddressL asm("r3");
 register uint8_t TWI_AddressH asm("r4");
 register uint8_t TWI_Size     asm("r5");
+register uint8_t TWI_Address  asm("r6");
+#endif
 
 
+bool BootExport_Open(void);
+bool BootExport_HasEntry(unsigned char);
 void TWI_ISR(void);
 bool TWI_Poll(unsigned char *);
 bool TWI_StartWrite(unsigned char, unsigned char *, unsigned char);
 bool TWI_StartRead(unsigned char, unsigned char *, unsigned char);
 void BCP_Open(struct BCP_Session *);
-bool BCP_HandleRequest(struct BCP_Session *restrict,
-                       bool (*)(unsigned long long, void *, unsigned char),
-                       bool (*)(unsigned long long, void *, unsigned char));
 
 
 /* Enable TWI interrupt.
@@ -48,4 +50,5 @@ static inline void BootExport_EnableTWIINT2(bool enable, void (*cb)(void))
    TWI_ENABLE_INT2(enable, cb);
 }
 
+
 #endif
@@ -13,12 +13,38 @@
 #include "XPT2046.h"
 #include "SSD1289.h"
 #include "BGUI.h"
+#include "Icons.h"
 
 /*General Flags*/
 #define FLAG_TWI_INT   (0x01)
 #define FLAG_TP_INT    (0x02)
 #define FLAG_TP_DOWN   (0x04)
 #define FLAG_TIMER_INT (0x08)
+#define FLAG_DRO_INT   (0x80)
+
+/*Platform timer slots*/
+#define TIMER_TOUCH (0x00)
+#define TIMER_DRO   (0x01)
+
+/* DRO (position readout) update period (ms). Only changed digits are
+ * repainted so the rate is limited by how often position changes, not by
+ * redrawing the readout.
+ */
+#define DRO_RATE_MS (0x32)
+
+/*BCP memory banks (upper 16-bit of address)*/
+#define BANK_SHIFT       (0x30)
+#define BANK_FRAMEBUFFER (0x0001)
+
+/* Framebuffer bank (read-only): RGB565 pixels (16-bit LE) in rows of FB_WIDTH
+ * from Y = 0. Reads are served from a cached segment (reads within one segment
+ * only), segment is captured from display when first read.
+ */
+#define FB_WIDTH    (0x0140)
+#define FB_HEIGHT   (0xF0)
+#define FB_SEGMENT  (0x40)
+#define FB_SEGMENTS ((FB_WIDTH / FB_SEGMENT) * FB_HEIGHT)
+#define FB_NONE     (0xFFFF)
 
 /*GUI Button ID's*/
 #define BTN_RAISE (0x00)
@@ -28,13 +54,42 @@
 #define BTN_UP    (0x04)
 #define BTN_DOWN  (0x05)
 
+/*GUI Label/Console ID's*/
+#define LBL_STATUS  (0x06)
+#define CON_LOG     (0x07)
+
+/*GUI Number ID's (DRO axis)*/
+#define NUM_X (0x08)
+#define NUM_Y (0x09)
+#define NUM_Z (0x0A)
+
 void TWIINT(void);
 void touchINT(void);
 void timerINT(void);
+void droINT(void);
+void droUpdate(void);
 void guiEvents(unsigned char, unsigned char);
+bool fbRead(unsigned long, unsigned char *, unsigned char);
+void fbCapture(unsigned int);
+
+/*GUI Button names (by ID)*/
+const char *const buttonNames[] =
+{
+   "Raise", "Lower", "Left", "Right", "Up", "Down"
+};
+
+/*DRO axis names (by ID - NUM_X)*/
+const char *const axisNames[] =
+{
+   "X ", "Y ", "Z "
+};
 
 /*Global variable*/
 volatile unsigned char flags = 0x00;
+struct BCP_Session bcp;
+unsigned int fbCache[FB_SEGMENT];
+unsigned int fbCached = FB_NONE;
+long position[0x03];
 
 
 /* Process memory read commands.
@@ -47,6 +102,16 @@ volatile unsigned char flags = 0x00;
  */
 bool memRead(unsigned long long addr, void *data, unsigned char size)
 {
+   if((addr >> BANK_SHIFT) == BANK_FRAMEBUFFER)
+   {
+      if(addr & 0x0000FFFF00000000ULL)
+      {
+         return true;
+      }
+
+      return fbRead((unsigned long)addr, data, size);
+   }
+
    return false;
 }
 
@@ -101,6 +166,18 @@ void timerINT(void)
 }
 
 
+/* DRO timer interrupt callback.
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void droINT(void)
+{
+   flags |= FLAG_DRO_INT;
+}
+
+
 /* GUI events callback.
  *
  * INPUT : id - id of GUI object
@@ -112,37 +189,126 @@ void guiEvents(unsigned char id, unsigned char ev)
 {
    if(ev == BGUI_BTN_DOWN)
    {
-      SSD1289_WriteString(0x00, 0x00, "Hit", 0xFFFF, 0x00);
+      BGUI_SetText(LBL_STATUS, "Hit");
+      BGUI_ConsoleWrite(buttonNames[id]);
+   }
+}
+
+
+/* Update DRO from axis position (position is held at zero until slave CNC
+ * controller axis control is implemented).
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void droUpdate(void)
+{
+   BGUI_SetNumber(NUM_X, position[0x00]);
+   BGUI_SetNumber(NUM_Y, position[0x01]);
+   BGUI_SetNumber(NUM_Z, position[0x02]);
+}
+
+
+/* Read from framebuffer bank (from cached segment).
+ *
+ * INPUT : offset - offset in framebuffer bank
+ *         size - size of data to be read
+ *
+ * OUTPUT: data - output buffer for read data
+ *         [Return] - true if error occurred, false otherwise
+ */
+bool fbRead(unsigned long offset, unsigned char *data, unsigned char size)
+{
+   unsigned int segment = (offset / (FB_SEGMENT * 0x02));
+   unsigned char start = (offset % (FB_SEGMENT * 0x02));
+
+   if((offset >= ((unsigned long)FB_SEGMENTS * FB_SEGMENT * 0x02)) ||
+      ((start + size) > (FB_SEGMENT * 0x02)))
+   {
+      return true;
    }
+
+   if(fbCached != segment)
+   {
+      fbCapture(segment);
+   }
+
+   /*Pixels are output as 16-bit LE*/
+   for(; size; size--, start++)
+   {
+      *data++ = (unsigned char)(fbCache[start / 0x02] >>
+                                ((start & 0x01) ? 0x08 : 0x00));
+   }
+
+   return false;
+}
+
+
+/* Capture framebuffer segment into cache.
+ *
+ * INPUT : segment - segment to capture
+ *
+ * OUTPUT: [None]
+ */
+void fbCapture(unsigned int segment)
+{
+   unsigned int pixel = (segment * FB_SEGMENT);
+
+   SSD1289_ReadRect(pixel % FB_WIDTH, pixel / FB_WIDTH, FB_SEGMENT, 0x01,
+                    fbCache);
+   fbCached = segment;
 }
 
 
 int main(void)
 {
-   struct BCP_Session bcp;
    unsigned int tpX;
    unsigned int tpY;
+   unsigned char i;
+   bool bcpOpen;
 
    /*Initialize libraries*/
    Platform_Open();
    XPT2046_Open();
    SSD1289_Open();
    BGUI_Open(guiEvents);
-   BCP_Open(&bcp);
+   /*BCP is unavailable if bootloader exports are incompatible*/
+   bcpOpen = !BootExport_Open();
+   if(bcpOpen)
+   {
+      BCP_Open(&bcp);
+   }
 
-   /*Create GUI*/
-   SSD1289_FillRect(0x00, 0x00, 0x0140, 0xF0, 0x00);
-   BGUI_CreateButton("Raise", 0x20, 0xB0, 0x40, 0x20, BTN_RAISE);
-   BGUI_CreateButton("Lower", 0x20, 0x80, 0x40, 0x20, BTN_LOWER);
-   BGUI_CreateButton("Left", 0x80, 0x50, 0x40, 0x20, BTN_LEFT);
-   BGUI_CreateButton("Right", 0xE0, 0x50, 0x40, 0x20, BTN_RIGHT);
-   BGUI_CreateButton("Up", 0xB0, 0x80, 0x40, 0x20, BTN_UP);
-   BGUI_CreateButton("Down", 0xB0, 0x20, 0x40, 0x20, BTN_DOWN);
+   /*Create GUI (painted by first render)*/
+   BGUI_CreateLabel("", 0x00, 0x00, 0x03 * SSD1289_FONT_WIDTH, LBL_STATUS);
+   BGUI_CreateConsole(0x00, 0x0E, 0x04, CON_LOG);
+   BGUI_CreateButton(buttonNames[BTN_RAISE], 0x20, 0xB0, 0x40, 0x20, BTN_RAISE);
+   BGUI_CreateButton(buttonNames[BTN_LOWER], 0x20, 0x80, 0x40, 0x20, BTN_LOWER);
+   BGUI_CreateButton(buttonNames[BTN_LEFT], 0x80, 0x50, 0x40, 0x20, BTN_LEFT);
+   BGUI_CreateButton(buttonNames[BTN_RIGHT], 0xE0, 0x50, 0x40, 0x20, BTN_RIGHT);
+   BGUI_CreateButton(buttonNames[BTN_UP], 0xB0, 0x80, 0x40, 0x20, BTN_UP);
+   BGUI_CreateButton(buttonNames[BTN_DOWN], 0xB0, 0x20, 0x40, 0x20, BTN_DOWN);
+   BGUI_SetIcon(BTN_RAISE, Icon_Raise);
+   BGUI_SetIcon(BTN_LOWER, Icon_Lower);
+   BGUI_SetIcon(BTN_LEFT, Icon_ArrowLeft);
+   BGUI_SetIcon(BTN_RIGHT, Icon_ArrowRight);
+   BGUI_SetIcon(BTN_UP, Icon_ArrowUp);
+   BGUI_SetIcon(BTN_DOWN, Icon_ArrowDown);
+   for(i = 0x00; i < 0x03; i++)
+   {
+      BGUI_CreateNumber(axisNames[i], 0xF0, 0xE0 - (i * 0x10), 0x08, 0x02,
+                        NUM_X + i);
+   }
 
    /*Setup interrupt sources and enable interrupts*/
    XPT2046_EnableINT(true, touchINT);
-   BootExport_EnableTWIINT2(true, TWIINT);
+   if(bcpOpen)
+   {
+      BootExport_EnableTWIINT2(true, TWIINT);
+   }
    Platform_EnableInterrupts(true);
+   Platform_SetTimer(TIMER_DRO, DRO_RATE_MS, droINT);
 
    while(0x01)
    {
@@ -159,7 +325,7 @@ int main(void)
          if(!XPT2046_GetXY(&tpX, &tpY))
          {
             XPT2046_EnableINT(false, NULL);
-            Platform_SetTimer(0x14, timerINT);
+            Platform_SetTimer(TIMER_TOUCH, 0x14, timerINT);
          }
 
          flags &= (~(FLAG_TP_INT));
@@ -186,11 +352,23 @@ int main(void)
                flags |= FLAG_TP_DOWN;
             }
 
-            Platform_SetTimer(0xC8, timerINT);
+            Platform_SetTimer(TIMER_TOUCH, 0xC8, timerINT);
          }
 
          flags &= (~(FLAG_TIMER_INT));
       }
+
+      /*Update DRO (partial repaint of changed digits only)*/
+      if(flags & FLAG_DRO_INT)
+      {
+         flags &= (~(FLAG_DRO_INT));
+         droUpdate();
+         Platform_SetTimer(TIMER_DRO, DRO_RATE_MS, droINT);
+      }
+
+      /*Repaint GUI areas invalidated this iteration*/
+      BGUI_Render();
+      Platform_Idle();
    }
 
    return 0x00;
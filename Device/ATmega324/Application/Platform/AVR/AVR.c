@@ -11,8 +11,12 @@
 #include "AVR.h"
 
 /*Global variables*/
-static unsigned char overflow;
-static unsigned int matches;
+static volatile unsigned char overflow;
+static volatile struct
+{
+   unsigned int matches;
+   void (*cb)(void);
+} timers[PLATFORM_TIMERS];
 
 
 /* Initialize AVR platform.
@@ -73,23 +77,40 @@ void Platform_EnableInterrupts(bool enable)
 }
 
 
-/* Set timer counters and callback.
+/* Set timer slot counters and callback. Timer0 provides a 1ms tick while any
+ * timer slot is active.
  *
- * INPUT : ms - time to delay until callback
+ * INPUT : timer - timer slot (below PLATFORM_TIMERS)
+ *         ms - time to delay until callback (0 to cancel)
  *         cb - callback when time elapses
  *
  * OUTPUT: [None]
  */
-void Platform_SetTimer(unsigned int ms, void (*cb)(void))
+void Platform_SetTimer(unsigned char timer, unsigned int ms, void (*cb)(void))
 {
-   xxPlatform_RegisterCB(cb, 0x02);
-   matches = ms;
-   overflow = 0x05;
+   unsigned char mask = TIMSK0;
 
-   TCCR0A = 0x00;
-   TIMSK0 = 0x01;
-   OCR0A = 0xDC;
-   TCCR0B = 0x02;
+   /*Slots are shared with interrupt context*/
+   TIMSK0 = 0x00;
+   if(cb != NULL)
+   {
+      timers[timer].cb = cb;
+   }
+   timers[timer].matches = ms;
+
+   /*Start tick if not running*/
+   if((ms != 0x00) &&
+      (TCCR0B == 0x00))
+   {
+      overflow = 0x05;
+      TCCR0A = 0x00;
+      TCNT0 = 0x00;
+      OCR0A = 0xDC;
+      TCCR0B = 0x02;
+      mask = 0x01;
+   }
+
+   TIMSK0 = mask;
 }
 
 
@@ -117,17 +138,38 @@ void (*xxPlatform_RegisterCB(void (*cb)(void), unsigned char index))(void)
 /*Timer0 Compare Match A interrupt vector*/
 ISR(TIMER0_COMPA_vect)
 {
-   matches--;
-   if(matches)
+   unsigned char i;
+   bool active = false;
+
+   /*Restart tick*/
+   overflow = 0x05;
+   TCNT0 = 0x00;
+   TIMSK0 = 0x01;
+
+   for(i = 0x00; i < PLATFORM_TIMERS; i++)
    {
-      overflow = 0x05;
-      TCNT0 = 0x00;
-      TIMSK0 = 0x01;
+      if(timers[i].matches)
+      {
+         timers[i].matches--;
+         if(!timers[i].matches)
+         {
+            timers[i].cb();
+         }
+      }
    }
-   else
+
+   /*Stop tick once no timer slot is active (callbacks may re-arm)*/
+   for(i = 0x00; i < PLATFORM_TIMERS; i++)
+   {
+      if(timers[i].matches)
+      {
+         active = true;
+      }
+   }
+
+   if(!active)
    {
       TCCR0B = 0x00;
-      xxPlatform_RegisterCB(NULL, 0x02)();
    }
 }
 
@@ -26,6 +26,7 @@
 #define SSD1289_SET_DATA_INPUT(x) xxPlatform_SetInput((x))
 #define SSD1289_SET_DATA16(x)     xxPlatform_SetData((x))
 #define SSD1289_GET_DATA16()      xxPlatform_GetData()
+#define SSD1289_PULSE_WR(x)       xxPlatform_PulseWR((x))
 
 /* XPT2046 (TP) - ATmega324:
  * (26)DCLK     - (38)PA2
@@ -54,10 +55,20 @@
  */
 #define LED_SET(x) xxPlatform_SetLED((x))
 
+/*Timer slots (sharing Timer0 1ms tick)*/
+#define PLATFORM_TIMERS (0x02)
+
+/*CPU cycles taken by an interface pin change (SBI/CBI)*/
+#define PLATFORM_PIN_CYCLES (0x02)
+
+/*CPU cycles (rounded up) covering nanosecond amount of time*/
+#define PLATFORM_NS_CYCLES(ns) ((((F_CPU) / 0x03E8UL) * (ns) + 0x000F423FUL) / \
+                                0x000F4240UL)
+
 void Platform_Open(void);
 void Platform_Close(void);
 void Platform_EnableInterrupts(bool);
-void Platform_SetTimer(unsigned int, void (*)(void));
+void Platform_SetTimer(unsigned char, unsigned int, void (*)(void));
 void (*xxPlatform_RegisterCB(void (*)(void), unsigned char))(void);
 
 
@@ -117,17 +128,29 @@ static inline void Platform_SleepUS(unsigned int us)
                                                ((double)ns) / 0x3B9ACA00 + 0.5F)
 
 
-/* Delay if nanosecond amount of time has not passed.
+/* Delay remainder of nanosecond amount of time not already covered by cycles
+ * of the surrounding instruction stream (budget resolved at compile-time, no
+ * code is emitted when covered).
+ *
+ * INPUT : ns - nanoseconds that must pass
+ *         cycles - CPU cycles known to pass (e.g. PLATFORM_PIN_CYCLES)
+ *
+ * OUTPUT: [None]
+ */
+#define Platform_HoldNS(ns, cycles) __builtin_avr_delay_cycles( \
+                      (PLATFORM_NS_CYCLES(ns) > (cycles)) ?       \
+                      (PLATFORM_NS_CYCLES(ns) - (cycles)) : 0x00)
+
+
+/* Finish main loop iteration (nothing to do as interrupts drive events).
  *
- * INPUT : last - address of variable to hold last time
- *         ns - nanoseconds that must have passed
+ * INPUT : [None]
  *
- * OUTPUT: last - current time
+ * OUTPUT: [None]
  */
-static inline void Platform_RepeatNS(unsigned int *last, unsigned int ns)
+static inline void Platform_Idle(void)
 {
-   /*AVR doesn't mark time implicitly, therefore sleep full amount*/
-   Platform_SleepNS(ns);
+
 }
 
 
@@ -281,6 +304,34 @@ static inline void xxPlatform_SetWR(bool val)
    }
 }
 
+
+/* Pulse WR (PB5) count times, toggling via PINB (single cycle per edge, which
+ * meets the SSD1289 minimum write pulse/cycle timing at up to 12MHz).
+ */
+#if F_CPU > 12000000UL
+#error AVR: Single cycle WR pulse too short for SSD1289 above 12MHz
+#endif
+static inline void xxPlatform_PulseWR(unsigned long count)
+{
+   unsigned char remainder = (unsigned char)(count & 0x07);
+
+   count >>= 0x03;
+   while(count--)
+   {
+      PINB = 0x20; PINB = 0x20; PINB = 0x20; PINB = 0x20;
+      PINB = 0x20; PINB = 0x20; PINB = 0x20; PINB = 0x20;
+      PINB = 0x20; PINB = 0x20; PINB = 0x20; PINB = 0x20;
+      PINB = 0x20; PINB = 0x20; PINB = 0x20; PINB = 0x20;
+   }
+
+   while(remainder--)
+   {
+      PINB = 0x20;
+      PINB = 0x20;
+   }
+}
+
+
 static inline void xxPlatform_SetInput(bool input)
 {
    if(input)
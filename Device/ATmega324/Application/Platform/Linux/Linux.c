@@ -0,0 +1,764 @@
+/******************************************************************************/
+/*Filename:    Linux.c                                                        */
+/*Project:     CNC 1                                                          */
+/*Author:      New Rupture Systems                                            */
+/*Description: Definitions for Linux (simulator) platform functions. Runs the */
+/*             application against a virtual SSD1289 (GRAM dumped as PPM      */
+/*             frames, bus cycles counted per frame) and a virtual XPT2046    */
+/*             (touches read from script) in virtual time.                    */
+/*                                                                            */
+/*             Environment variables:                                         */
+/*             SIM_TOUCH  - touch script, lines of "<ms> down <x> <y>" or     */
+/*                          "<ms> up" ('#' starts a comment), times from start*/
+/*             SIM_FRAMES - directory to write frame_NNNN.ppm files to        */
+/******************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "BootExport.h"
+#include "Linux.h"
+
+/*Display (landscape) size*/
+#define LCD_WIDTH  (0x0140)
+#define LCD_HEIGHT (0xF0)
+
+/*Time simulation continues after last script event (1 second)*/
+#define SETTLE_NS (0x3B9ACA00ULL)
+
+/*Time taken by an interface pin change (modelling an AVR at F_CPU)*/
+#define PIN_NS ((PLATFORM_PIN_CYCLES * 0x3B9ACA00UL) / (F_CPU))
+
+/*Bus activity counters*/
+struct Counters
+{
+   unsigned long cycles;
+   unsigned long indexes;
+   unsigned long registers;
+   unsigned long pixels;
+   unsigned long reads;
+   unsigned long pins;
+   unsigned long long delay;
+};
+
+static void lcdUpdate(void);
+static void lcdWrite(void);
+static void lcdRead(void);
+static void lcdAdvance(void);
+static unsigned int tpConvert(unsigned char);
+static void endFrame(void);
+static void writeFrame(void);
+static void readEvent(void);
+
+/*Global variables*/
+static unsigned long long now;
+static bool interrupts;
+static struct
+{
+   bool active;
+   unsigned long long deadline;
+   void (*cb)(void);
+} timers[PLATFORM_TIMERS];
+static unsigned int frames;
+static unsigned long maxCycles;
+static struct Counters frame;
+static struct Counters total;
+static const char *frameDir;
+static FILE *script;
+static unsigned long long lastEvent;
+
+/*Virtual SSD1289 state*/
+static struct
+{
+   bool cs;
+   bool rs;
+   bool rd;
+   bool wr;
+   bool input;
+   bool writing;
+   bool reading;
+   bool dummy;
+   unsigned int bus;
+   unsigned int out;
+   unsigned char index;
+   unsigned int reg[0x0100];
+   unsigned int gram[LCD_HEIGHT][LCD_WIDTH];
+} lcd;
+
+/*Virtual XPT2046 state*/
+static struct
+{
+   bool cs;
+   bool dclk;
+   bool in;
+   bool out;
+   bool busy;
+   bool down;
+   bool irq;
+   unsigned char control;
+   unsigned char clocks;
+   unsigned int result;
+   unsigned int x;
+   unsigned int y;
+   void (*cb)(void);
+} tp;
+
+/*Next script touch event*/
+static struct
+{
+   bool valid;
+   bool down;
+   unsigned long long time;
+   unsigned int x;
+   unsigned int y;
+} event;
+
+
+/* Initialize Linux (simulator) platform.
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void Platform_Open(void)
+{
+   const char *path;
+
+   /*Interface pins idle HIGH, controllers at reset values*/
+   lcd.cs = lcd.rd = lcd.wr = true;
+   lcd.reg[0x44] = ((LCD_HEIGHT - 0x01) << 0x08);
+   lcd.reg[0x46] = (LCD_WIDTH - 0x01);
+   tp.cs = true;
+
+   frameDir = getenv("SIM_FRAMES");
+   path = getenv("SIM_TOUCH");
+   if(path != NULL)
+   {
+      script = fopen(path, "r");
+      if(script == NULL)
+      {
+         fprintf(stderr, "Cannot open touch script '%s'\n", path);
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   readEvent();
+}
+
+
+/* Cleanup Linux (simulator) specific resources.
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void Platform_Close(void)
+{
+   if(script != NULL)
+   {
+      fclose(script);
+      script = NULL;
+   }
+}
+
+
+/* Enable global interrupts (callbacks are only made from Platform_Idle()).
+ *
+ * INPUT : enable - true to enable interrupts, false otherwise
+ *
+ * OUTPUT: [None]
+ */
+void Platform_EnableInterrupts(bool enable)
+{
+   interrupts = enable;
+}
+
+
+/* Set timer slot counters and callback.
+ *
+ * INPUT : timer - timer slot (below PLATFORM_TIMERS)
+ *         ms - time to delay until callback (0 to cancel)
+ *         cb - callback when time elapses
+ *
+ * OUTPUT: [None]
+ */
+void Platform_SetTimer(unsigned char timer, unsigned int ms, void (*cb)(void))
+{
+   /*Add callback only if non-NULL (as AVR)*/
+   if(cb != NULL)
+   {
+      timers[timer].cb = cb;
+   }
+
+   timers[timer].active = (ms != 0x00);
+   timers[timer].deadline = now + (ms * 0x000F4240ULL);
+}
+
+
+/* Finish main loop iteration (ending frame if display was accessed) and
+ * advance virtual time to next event (timer or touch), making its callback.
+ * Exits once touch script is done and no timer remains.
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void Platform_Idle(void)
+{
+   void (*cb)(void) = NULL;
+   unsigned char timer = PLATFORM_TIMERS;
+   unsigned char i;
+
+   endFrame();
+
+   /*Find first timer to elapse*/
+   for(i = 0x00; i < PLATFORM_TIMERS; i++)
+   {
+      if(timers[i].active &&
+         ((timer == PLATFORM_TIMERS) ||
+          (timers[i].deadline < timers[timer].deadline)))
+      {
+         timer = i;
+      }
+   }
+
+   /*Stop when nothing can happen anymore (timers are followed for a while
+     after script ends)*/
+   if(!event.valid &&
+      ((timer == PLATFORM_TIMERS) ||
+       (timers[timer].deadline > (lastEvent + SETTLE_NS))))
+   {
+      printf("%u frames, %lu bus cycles (%lu max, %lu average per frame), "
+             "%lu pixels, %lu pin operations, %llu ns delay, %llu ms\n",
+             frames, total.cycles, maxCycles,
+             (frames) ? (total.cycles / frames) : 0, total.pixels, total.pins,
+             total.delay, now / 0x000F4240ULL);
+      Platform_Close();
+      exit(EXIT_SUCCESS);
+   }
+
+   if((timer != PLATFORM_TIMERS) &&
+      (!event.valid || (timers[timer].deadline <= event.time)))
+   {
+      if(timers[timer].deadline > now)
+      {
+         now = timers[timer].deadline;
+      }
+
+      cb = timers[timer].cb;
+      timers[timer].active = false;
+   }
+   else
+   {
+      if(event.time > now)
+      {
+         now = event.time;
+      }
+
+      /*Pen state change (PENIRQ pin change interrupt)*/
+      tp.down = event.down;
+      tp.x = event.x;
+      tp.y = event.y;
+      if(tp.irq)
+      {
+         cb = tp.cb;
+      }
+
+      readEvent();
+   }
+
+   if(interrupts && (cb != NULL))
+   {
+      cb();
+   }
+}
+
+
+/* Delay execution by variable time in nanoseconds (virtual time).
+ *
+ * INPUT : ns - nanoseconds to delay execution
+ *
+ * OUTPUT: [None]
+ */
+void Platform_SleepNS(unsigned long ns)
+{
+   frame.delay += ns;
+   now += ns;
+}
+
+
+/* Delay remainder of nanosecond amount of time not already covered by cycles
+ * of the instruction stream (virtual time, only pin changes take time).
+ *
+ * INPUT : ns - nanoseconds that must pass
+ *         cycles - CPU cycles known to pass (e.g. PLATFORM_PIN_CYCLES)
+ *
+ * OUTPUT: [None]
+ */
+void Platform_HoldNS(unsigned long ns, unsigned char cycles)
+{
+   unsigned long covered = ((cycles * 0x3B9ACA00UL) / (F_CPU));
+
+   if(ns > covered)
+   {
+      Platform_SleepNS(ns - covered);
+   }
+}
+
+
+/*==============================================*/
+/* The below set of functions complete the      */
+/* respective interfaces of the interface       */
+/* macros (virtual SSD1289 and XPT2046 pins).   */
+/*==============================================*/
+void xxPlatform_SetCS(bool val)
+{
+   frame.pins++;
+   now += PIN_NS;
+   lcd.cs = val;
+   lcdUpdate();
+}
+
+
+void xxPlatform_SetRS(bool val)
+{
+   frame.pins++;
+   now += PIN_NS;
+   lcd.rs = val;
+}
+
+
+void xxPlatform_SetRD(bool val)
+{
+   frame.pins++;
+   now += PIN_NS;
+   lcd.rd = val;
+   lcdUpdate();
+}
+
+
+void xxPlatform_SetWR(bool val)
+{
+   frame.pins++;
+   now += PIN_NS;
+   lcd.wr = val;
+   lcdUpdate();
+}
+
+
+void xxPlatform_SetInput(bool input)
+{
+   frame.pins++;
+   now += PIN_NS;
+   lcd.input = input;
+}
+
+
+void xxPlatform_SetData(unsigned int data)
+{
+   frame.pins++;
+   now += PIN_NS;
+   lcd.bus = (data & 0xFFFF);
+}
+
+
+unsigned int xxPlatform_GetData(void)
+{
+   frame.pins++;
+   now += PIN_NS;
+   return (lcd.input) ? lcd.out : lcd.bus;
+}
+
+
+void xxPlatform_SetCS2(bool val)
+{
+   /*Conversion ends when deselected*/
+   if(val)
+   {
+      tp.busy = false;
+      tp.clocks = 0x00;
+   }
+
+   tp.cs = val;
+}
+
+
+void xxPlatform_EnableIRQ(bool enable, void (*cb)(void))
+{
+   /*Add callback only if non-NULL (as AVR)*/
+   if(cb != NULL)
+   {
+      tp.cb = cb;
+   }
+
+   tp.irq = enable;
+}
+
+
+void xxPlatform_SetDCLK(bool val)
+{
+   if(!tp.cs)
+   {
+      if(val && !tp.dclk)
+      {
+         /*Control byte shifted in on rising edge, conversion follows*/
+         if(tp.clocks < 0x08)
+         {
+            tp.control = ((tp.control << 0x01) | tp.in);
+            if(tp.clocks == 0x07)
+            {
+               tp.result = tpConvert(tp.control);
+               tp.busy = true;
+            }
+         }
+
+         tp.clocks++;
+      }
+      else if(!val && tp.dclk && (tp.clocks > 0x08))
+      {
+         /*Result (12-bit, MSB first) shifted out on falling edge*/
+         tp.out = ((tp.clocks <= 0x14) &&
+                   ((tp.result >> (0x14 - tp.clocks)) & 0x01));
+      }
+   }
+
+   tp.dclk = val;
+}
+
+
+void xxPlatform_SetIN(bool val)
+{
+   tp.in = val;
+}
+
+
+bool xxPlatform_GetOUT(void)
+{
+   return tp.out;
+}
+
+
+bool xxPlatform_GetBUSY(void)
+{
+   return tp.busy;
+}
+
+
+/*==============================================*/
+/* Bootloader exports (no bootloader is present */
+/* therefore BCP is unavailable).               */
+/*==============================================*/
+bool BootExport_Open(void)
+{
+   return true;
+}
+
+
+bool BootExport_HasEntry(unsigned char entry)
+{
+   return false;
+}
+
+
+void TWI_ISR(void)
+{
+
+}
+
+
+bool TWI_Poll(unsigned char *remainder)
+{
+   *remainder = 0x00;
+   return false;
+}
+
+
+bool TWI_StartWrite(unsigned char addr, unsigned char *buf, unsigned char size)
+{
+   return false;
+}
+
+
+bool TWI_StartRead(unsigned char addr, unsigned char *buf, unsigned char size)
+{
+   return false;
+}
+
+
+void BCP_Open(struct BCP_Session *bcp)
+{
+
+}
+
+
+/* Update virtual SSD1289 after a strobe (CS, WR, RD) pin change.
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void lcdUpdate(void)
+{
+   bool writing = (!lcd.cs && !lcd.wr);
+   bool reading = (!lcd.cs && !lcd.rd);
+
+   /*Write is latched on rising edge of WR (or CS)*/
+   if(lcd.writing && !writing)
+   {
+      lcdWrite();
+   }
+
+   /*Read data is output on falling edge of RD (or CS)*/
+   if(!lcd.reading && reading)
+   {
+      lcdRead();
+   }
+
+   lcd.writing = writing;
+   lcd.reading = reading;
+}
+
+
+/* Latch data bus into index register, register or GRAM.
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void lcdWrite(void)
+{
+   frame.cycles++;
+   if(!lcd.rs)
+   {
+      lcd.index = (unsigned char)lcd.bus;
+      lcd.dummy = true;
+      frame.indexes++;
+   }
+   else if(lcd.index == 0x22)
+   {
+      lcd.gram[lcd.reg[0x4E] % LCD_HEIGHT][lcd.reg[0x4F] % LCD_WIDTH] =
+                                                                       lcd.bus;
+      lcdAdvance();
+      frame.pixels++;
+   }
+   else
+   {
+      lcd.reg[lcd.index] = lcd.bus;
+      if((lcd.index == 0x4E) || (lcd.index == 0x4F))
+      {
+         lcd.dummy = true;
+      }
+      frame.registers++;
+   }
+}
+
+
+/* Output register or GRAM data (first read after address change is a dummy
+ * read).
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void lcdRead(void)
+{
+   frame.cycles++;
+   frame.reads++;
+   if(!lcd.rs || lcd.dummy)
+   {
+      lcd.out = 0x00;
+      lcd.dummy = false;
+   }
+   else if(lcd.index == 0x22)
+   {
+      lcd.out = lcd.gram[lcd.reg[0x4E] % LCD_HEIGHT][lcd.reg[0x4F] % LCD_WIDTH];
+      lcdAdvance();
+   }
+   else
+   {
+      lcd.out = lcd.reg[lcd.index];
+   }
+}
+
+
+/* Advance GRAM address counter (X first, wrapping within window).
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void lcdAdvance(void)
+{
+   if(lcd.reg[0x4F] == lcd.reg[0x46])
+   {
+      lcd.reg[0x4F] = lcd.reg[0x45];
+      if(lcd.reg[0x4E] == (lcd.reg[0x44] >> 0x08))
+      {
+         lcd.reg[0x4E] = (lcd.reg[0x44] & 0xFF);
+      }
+      else
+      {
+         lcd.reg[0x4E] = ((lcd.reg[0x4E] + 0x01) % LCD_HEIGHT);
+      }
+   }
+   else
+   {
+      lcd.reg[0x4F] = ((lcd.reg[0x4F] + 0x01) % LCD_WIDTH);
+   }
+}
+
+
+/* Get virtual XPT2046 conversion (inverse of XPT2046_GetXY() scaling).
+ *
+ * INPUT : control - control byte specifying conversion parameters
+ *
+ * OUTPUT: [Return] - conversion result
+ */
+unsigned int tpConvert(unsigned char control)
+{
+   if(!tp.down)
+   {
+      return 0x00;
+   }
+
+   switch((control >> 0x04) & 0x07)
+   {
+      case 0x01:
+         return ((tp.x * 0x0A) + 0x0131);
+
+      case 0x03:
+         return 0x0200;
+
+      case 0x05:
+         return ((tp.y * 0x0C) + 0x01FA);
+
+      default:
+         return 0x00;
+   }
+}
+
+
+/* End current frame if display was accessed (output counters, write frame).
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void endFrame(void)
+{
+   if(!frame.cycles)
+   {
+      return;
+   }
+
+   printf("frame %04u @ %llu ms: %lu bus cycles (%lu index, %lu register, "
+          "%lu pixel, %lu read), %lu pin operations, %llu ns delay\n",
+          frames, now / 0x000F4240ULL, frame.cycles, frame.indexes,
+          frame.registers, frame.pixels, frame.reads, frame.pins,
+          frame.delay);
+   if(frameDir != NULL)
+   {
+      writeFrame();
+   }
+
+   if(frame.cycles > maxCycles)
+   {
+      maxCycles = frame.cycles;
+   }
+
+   total.cycles += frame.cycles;
+   total.indexes += frame.indexes;
+   total.registers += frame.registers;
+   total.pixels += frame.pixels;
+   total.reads += frame.reads;
+   total.pins += frame.pins;
+   total.delay += frame.delay;
+   memset(&frame, 0x00, sizeof(frame));
+   frames++;
+}
+
+
+/* Write GRAM (top row is highest Y) to PPM file in frames directory.
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void writeFrame(void)
+{
+   char path[0x0400];
+   unsigned char rgb[LCD_WIDTH * 0x03];
+   unsigned int x;
+   unsigned int y;
+   unsigned int colour;
+   FILE *f;
+
+   snprintf(path, sizeof(path), "%s/frame_%04u.ppm", frameDir, frames);
+   f = fopen(path, "wb");
+   if(f == NULL)
+   {
+      fprintf(stderr, "Cannot write frame '%s'\n", path);
+      exit(EXIT_FAILURE);
+   }
+
+   fprintf(f, "P6\n%u %u\n255\n", LCD_WIDTH, LCD_HEIGHT);
+   for(y = LCD_HEIGHT; y--;)
+   {
+      /*Expand RGB565 to RGB888*/
+      for(x = 0x00; x < LCD_WIDTH; x++)
+      {
+         colour = lcd.gram[y][x];
+         rgb[(x * 0x03) + 0x00] = (((colour >> 0x0B) & 0x1F) * 0xFF) / 0x1F;
+         rgb[(x * 0x03) + 0x01] = (((colour >> 0x05) & 0x3F) * 0xFF) / 0x3F;
+         rgb[(x * 0x03) + 0x02] = ((colour & 0x1F) * 0xFF) / 0x1F;
+      }
+      fwrite(rgb, sizeof(rgb), 0x01, f);
+   }
+
+   fclose(f);
+}
+
+
+/* Read next touch event from script (invalid if none remain).
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void readEvent(void)
+{
+   char line[0x0100];
+   char action[0x08];
+   unsigned long ms;
+   int fields;
+
+   event.valid = false;
+   while((script != NULL) && (fgets(line, sizeof(line), script) != NULL))
+   {
+      line[strcspn(line, "#\r\n")] = '\0';
+      fields = sscanf(line, "%lu %7s %u %u", &ms, action, &event.x, &event.y);
+      if(fields <= 0)
+      {
+         continue;
+      }
+
+      if((fields == 0x04) && !strcmp(action, "down"))
+      {
+         event.down = true;
+      }
+      else if((fields == 0x02) && !strcmp(action, "up"))
+      {
+         event.down = false;
+      }
+      else
+      {
+         fprintf(stderr, "Invalid touch script line '%s'\n", line);
+         exit(EXIT_FAILURE);
+      }
+
+      event.time = (ms * 0x000F4240ULL);
+      lastEvent = event.time;
+      event.valid = true;
+      break;
+   }
+}
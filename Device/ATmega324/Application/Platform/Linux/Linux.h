@@ -0,0 +1,108 @@
+/******************************************************************************/
+/*Filename:    Linux.h                                                        */
+/*Project:     CNC 1                                                          */
+/*Author:      New Rupture Systems                                            */
+/*Description: Declaration/definitions for Linux (simulator) platform         */
+/*             functions. Emulates the SSD1289 and XPT2046 behind the same pin*/
+/*             level interface macros used on AVR.                            */
+/******************************************************************************/
+#ifndef LINUX_H
+#define LINUX_H
+#include <stdbool.h>
+
+/* SSD1289 (LCD) - virtual controller (register file, GRAM and address
+ * counter), counting bus cycles per frame.
+ */
+#define SSD1289_SET_CS(x)         xxPlatform_SetCS((x))
+#define SSD1289_SET_RS(x)         xxPlatform_SetRS((x))
+#define SSD1289_SET_RD(x)         xxPlatform_SetRD((x))
+#define SSD1289_SET_WR(x)         xxPlatform_SetWR((x))
+#define SSD1289_SET_DATA_INPUT(x) xxPlatform_SetInput((x))
+#define SSD1289_SET_DATA16(x)     xxPlatform_SetData((x))
+#define SSD1289_GET_DATA16()      xxPlatform_GetData()
+
+/* XPT2046 (TP) - virtual controller, touches fed from script (SIM_TOUCH).
+ */
+#define XPT2046_SET_CS(x)        xxPlatform_SetCS2((x))
+#define XPT2046_ENABLE_IRQ(x, y) xxPlatform_EnableIRQ((x), (y))
+#define XPT2046_SET_INPUT(x)     ((void)(x))
+#define XPT2046_SET_DCLK(x)      xxPlatform_SetDCLK((x))
+#define XPT2046_SET_IN(x)        xxPlatform_SetIN((x))
+#define XPT2046_GET_OUT()        xxPlatform_GetOUT()
+#define XPT2046_GET_BUSY()       xxPlatform_GetBUSY()
+
+/* TWI (I2C) - no bootloader (BCP unavailable)
+ */
+#define TWI_ENABLE_INT2(x, y) ((void)(x), (void)(y))
+
+/* LED - ignored
+ */
+#define LED_SET(x) ((void)(x))
+
+/*Timer slots (as AVR)*/
+#define PLATFORM_TIMERS (0x02)
+
+/*CPU cycles taken by an interface pin change (as AVR, at F_CPU)*/
+#define PLATFORM_PIN_CYCLES (0x02)
+
+void Platform_Open(void);
+void Platform_Close(void);
+void Platform_EnableInterrupts(bool);
+void Platform_SetTimer(unsigned char, unsigned int, void (*)(void));
+void Platform_Idle(void);
+void Platform_SleepNS(unsigned long);
+void Platform_HoldNS(unsigned long, unsigned char);
+
+void xxPlatform_SetCS(bool);
+void xxPlatform_SetRS(bool);
+void xxPlatform_SetRD(bool);
+void xxPlatform_SetWR(bool);
+void xxPlatform_SetInput(bool);
+void xxPlatform_SetData(unsigned int);
+unsigned int xxPlatform_GetData(void);
+void xxPlatform_SetCS2(bool);
+void xxPlatform_EnableIRQ(bool, void (*)(void));
+void xxPlatform_SetDCLK(bool);
+void xxPlatform_SetIN(bool);
+bool xxPlatform_GetOUT(void);
+bool xxPlatform_GetBUSY(void);
+
+
+/* Delay execution by variable time in seconds (virtual time).
+ *
+ * INPUT : s - seconds to delay execution
+ *
+ * OUTPUT: [None]
+ */
+static inline void Platform_Sleep(unsigned int s)
+{
+   while(s--)
+   {
+      Platform_SleepNS(0x3B9ACA00);
+   }
+}
+
+
+/* Delay execution by variable time in milliseconds (virtual time).
+ *
+ * INPUT : ms - milliseconds to delay execution
+ *
+ * OUTPUT: [None]
+ */
+static inline void Platform_SleepMS(unsigned int ms)
+{
+   Platform_SleepNS(ms * 0x000F4240UL);
+}
+
+
+/* Delay execution by variable time in microseconds (virtual time).
+ *
+ * INPUT : us - microseconds to delay execution
+ *
+ * OUTPUT: [None]
+ */
+static inline void Platform_SleepUS(unsigned int us)
+{
+   Platform_SleepNS(us * 0x03E8UL);
+}
+#endif
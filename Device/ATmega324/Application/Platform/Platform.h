@@ -13,6 +13,8 @@
 
 #if PLATFORM_ARCH == PLATFORM_AVR
 #include "AVR/AVR.h"
+#elif PLATFORM_ARCH == PLATFORM_LINUX
+#include "Linux/Linux.h"
 #else
 #error Missing platform definitions for target platform
 #endif
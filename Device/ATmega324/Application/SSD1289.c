@@ -7,10 +7,13 @@
 #include <stdbool.h>
 #include <string.h>
 #include "Platform.h"
-#include "CharMap.h"
+#include "CharRuns.h"
 #include "SSD1289.h"
 #if PLATFORM_ARCH == PLATFORM_AVR
 #include <avr/pgmspace.h>
+#define READ_ROM(x) pgm_read_byte((x))
+#else
+#define READ_ROM(x) (*(x))
 #endif
 
 /*Check that interface pins are assigned*/
@@ -24,11 +27,50 @@
 #error SSD1289: Interface macro functions not defined
 #endif
 
+/*Pulse WR (with data latched) if no platform burst implementation exists*/
+#if !defined(SSD1289_PULSE_WR)
+#define SSD1289_PULSE_WR(x) pulseWR((x))
+#define SSD1289_GENERIC_PULSE_WR
+static void pulseWR(unsigned long);
+#endif
+
+/*Shadowed (cached) window and cursor registers*/
+#define SHADOW_WINDOW_V  (0x00)
+#define SHADOW_WINDOW_HS (0x01)
+#define SHADOW_WINDOW_HE (0x02)
+#define SHADOW_CURSOR_Y  (0x03)
+#define SHADOW_CURSOR_X  (0x04)
+#define SHADOW_COUNT     (0x05)
+#define SHADOW_BIT(x)    (0x01 << (x))
+#define SHADOW_WINDOW    (SHADOW_BIT(SHADOW_WINDOW_V) | \
+                          SHADOW_BIT(SHADOW_WINDOW_HS) | \
+                          SHADOW_BIT(SHADOW_WINDOW_HE))
+#define SHADOW_CURSOR    (SHADOW_BIT(SHADOW_CURSOR_Y) | \
+                          SHADOW_BIT(SHADOW_CURSOR_X))
+
+static const unsigned char shadowRegister[SHADOW_COUNT] =
+{
+   0x44, 0x45, 0x46, 0x4E, 0x4F
+};
+
+static struct
+{
+   unsigned int value[SHADOW_COUNT];
+   unsigned char valid;
+} shadow;
+
+static void setWindow(const unsigned int, const unsigned char,
+                      const unsigned int, const unsigned char);
+static void setCursor(const unsigned int, const unsigned char);
+static void setShadowRegister(const unsigned char, const unsigned int);
 static void setRegister(const unsigned char);
 static void setRegisterValue(const unsigned char, const unsigned int);
-static unsigned int readValue(void);
+static void readValues(unsigned int *, unsigned long);
+static unsigned int readData(void);
 static void writeValue(const unsigned int);
 static void writeData(const unsigned int);
+static void burstValue(const unsigned int, unsigned long);
+static void writeRun(const unsigned int, const unsigned int);
 
 
 /* Open default SSD1289 session.
@@ -40,6 +82,7 @@ static void writeData(const unsigned int);
 bool SSD1289_Open(void)
 {
    /*Configure display to usable state*/
+   shadow.valid = 0x00;
    SSD1289_SET_CS(true);
    /*Set internal display on (external off), GND display drivers*/
    setRegisterValue(0x07, 0x21);
@@ -97,10 +140,19 @@ void SSD1289_Close(void)
 void SSD1289_SetPixel(const unsigned int x, const unsigned char y,
                       const unsigned int colour)
 {
-   setRegisterValue(0x4F, x);
-   setRegisterValue(0x4E, y);
+   setCursor(x, y);
    setRegister(0x22);
    writeValue(colour);
+
+   /*Cursor advances along line (unless wrapping at window edge)*/
+   if(x < shadow.value[SHADOW_WINDOW_HE])
+   {
+      shadow.value[SHADOW_CURSOR_X]++;
+   }
+   else
+   {
+      shadow.valid &= (~SHADOW_CURSOR);
+   }
 }
 
 
@@ -113,10 +165,39 @@ void SSD1289_SetPixel(const unsigned int x, const unsigned char y,
  */
 unsigned int SSD1289_GetPixel(const unsigned int x, const unsigned char y)
 {
-   setRegisterValue(0x4F, x);
-   setRegisterValue(0x4E, y);
+   unsigned int colour;
+
+   setCursor(x, y);
    setRegister(0x22);
-   return readValue();
+   readValues(&colour, 0x01);
+   shadow.valid &= (~SHADOW_CURSOR);
+
+   return colour;
+}
+
+
+/* Read rectangle at (x, y) location of size (width, height). Window is set
+ * once and pixels are streamed (single dummy read, CS held LOW).
+ *
+ * INPUT : x - X coordinate
+ *         y - Y coordinate
+ *         width - width of rectangle
+ *         height - height of rectangle
+ *
+ * OUTPUT: pixels - pixel colours (row by row from y, width * height)
+ */
+void SSD1289_ReadRect(const unsigned int x, const unsigned char y,
+                      const unsigned int width, const unsigned char height,
+                      unsigned int *pixels)
+{
+   /*Set start (x, y) and wrap (width, height)*/
+   setWindow(x, y, width, height);
+   setCursor(x, y);
+   setRegister(0x22);
+
+   /*Read pixel data*/
+   readValues(pixels, (unsigned long)width * height);
+   shadow.valid &= (~SHADOW_CURSOR);
 }
 
 
@@ -137,23 +218,13 @@ void SSD1289_FillRect(const unsigned int x, const unsigned char y,
    unsigned long total = (unsigned long)width * height;
 
    /*Set start (x, y) and wrap (width, height)*/
-   setRegisterValue(0x4F, x);
-   setRegisterValue(0x4E, y);
-   setRegisterValue(0x45, x);
-   setRegisterValue(0x46, x + (width - 0x01));
-   setRegisterValue(0x44, (((unsigned int)y + (height - 0x01)) << 0x08) | y);
+   setWindow(x, y, width, height);
+   setCursor(x, y);
    setRegister(0x22);
 
    /*Write pixel data*/
-   while(total--)
-   {
-      writeValue(colour);
-   }
-
-   /*Restore default wrap*/
-   setRegisterValue(0x45, 0x00);
-   setRegisterValue(0x46, 0x013F);
-   setRegisterValue(0x44, 0xEF << 0x08);
+   burstValue(colour, total);
+   shadow.valid &= (~SHADOW_CURSOR);
 }
 
 
@@ -173,37 +244,45 @@ void SSD1289_WriteString(const unsigned int x, const unsigned char y,
                          const unsigned int backColour)
 {
    unsigned char i;
-   unsigned char charLine;
+   unsigned char row;
+   unsigned char run;
+   unsigned char pixels;
    unsigned char len = strlen(str);
    unsigned char line = 0x00;
+   unsigned int colour;
+   unsigned int runColour = backColour;
+   unsigned int runLength = 0x00;
    const char *c = str;
 
    /*Set start (x, y) and wrap (width, height)*/
-   setRegisterValue(0x4F, x);
-   setRegisterValue(0x4E, y);
-   setRegisterValue(0x45, x);
-   setRegisterValue(0x46, x + ((len * 0x08) - 0x01));
-   setRegisterValue(0x44, (((unsigned int)y + (0x0C - 0x01)) << 0x08) | y);
+   setWindow(x, y, (len * 0x08), 0x0C);
+   setCursor(x, y);
    setRegister(0x22);
+   SSD1289_SET_RS(true);
+   SSD1289_SET_WR(true);
+   SSD1289_SET_CS(false);
 
-   /*Write character pixel data*/
+   /*Write character pixel data (merging glyph row runs of same colour)*/
    while(line != 0x0C)
    {
-#if PLATFORM_ARCH == PLATFORM_AVR
-      charLine = pgm_read_byte(&CharMap_Bitmap[((*c) - 0x20) + (line * 0x60)]);
-#else
-      charLine = CharMap_Bitmap[((*c) - 0x20) + (line * 0x60)];
-#endif
-      for(i = 0x00; i < 0x08; i++)
+      row = READ_ROM(&CharRuns_Index[((*c) - 0x20) + (line * 0x60)]);
+      for(i = 0x00, pixels = 0x00; pixels < 0x08; i++)
       {
-         if(charLine & (0x80 >> i))
+         run = READ_ROM(&CharRuns_Runs[row][i / 0x02]);
+         if(!(i & 0x01))
          {
-            writeValue(foreColour);
+            run >>= 0x04;
          }
-         else
+
+         colour = ((run & 0x08) ? foreColour : backColour);
+         if(colour != runColour)
          {
-            writeValue(backColour);
+            writeRun(runColour, runLength);
+            runColour = colour;
+            runLength = 0x00;
          }
+         runLength += ((run & 0x07) + 0x01);
+         pixels += ((run & 0x07) + 0x01);
       }
 
       c++;
@@ -214,10 +293,161 @@ void SSD1289_WriteString(const unsigned int x, const unsigned char y,
       }
    }
 
-   /*Restore default wrap*/
-   setRegisterValue(0x45, 0x00);
-   setRegisterValue(0x46, 0x013F);
-   setRegisterValue(0x44, 0xEF << 0x08);
+   writeRun(runColour, runLength);
+   SSD1289_SET_CS(true);
+   shadow.valid &= (~SHADOW_CURSOR);
+}
+
+
+/* Get size of RLE image (see SSD1289_DrawImage()).
+ *
+ * INPUT : image - image (in ROM)
+ *
+ * OUTPUT: width - width of image
+ *         height - height of image
+ */
+void SSD1289_GetImageSize(const unsigned char *image, unsigned int *width,
+                          unsigned char *height)
+{
+   *width = (READ_ROM(&image[0x00]) | (READ_ROM(&image[0x01]) << 0x08));
+   *height = READ_ROM(&image[0x02]);
+}
+
+
+/* Draw RLE RGB565 image (streamed from ROM, generated from XPM by build).
+ * Image is width (16-bit LE) and height (8-bit) followed by tokens:
+ *    0x00-0x7F: run of n + 1 pixels of following colour (16-bit LE)
+ *    0x80-0xBF: (n & 0x3F) + 1 literal pixels follow (16-bit LE each)
+ *    0xC0-0xFF: run of (n & 0x3F) + 1 pixels of background colour
+ * Rows are stored from lowest Y (bottom of display) upwards.
+ *
+ * INPUT : x - X coordinate
+ *         y - Y coordinate
+ *         image - image (in ROM)
+ *         backColour - colour of background (transparent) pixels
+ *
+ * OUTPUT: [None]
+ */
+void SSD1289_DrawImage(const unsigned int x, const unsigned char y,
+                       const unsigned char *image,
+                       const unsigned int backColour)
+{
+   unsigned int width;
+   unsigned char height;
+   unsigned char token;
+   unsigned char count;
+   unsigned int colour;
+   unsigned long total;
+
+   SSD1289_GetImageSize(image, &width, &height);
+   total = ((unsigned long)width * height);
+   image += 0x03;
+
+   /*Set start (x, y) and wrap (width, height)*/
+   setWindow(x, y, width, height);
+   setCursor(x, y);
+   setRegister(0x22);
+   SSD1289_SET_RS(true);
+   SSD1289_SET_WR(true);
+   SSD1289_SET_CS(false);
+
+   /*Decode runs directly into display writes*/
+   while(total)
+   {
+      token = READ_ROM(image++);
+      if(token < 0x80)
+      {
+         count = (token + 0x01);
+         colour = (READ_ROM(&image[0x00]) | (READ_ROM(&image[0x01]) << 0x08));
+         image += 0x02;
+         writeRun(colour, count);
+      }
+      else if(token < 0xC0)
+      {
+         count = ((token & 0x3F) + 0x01);
+         for(token = count; token; token--)
+         {
+            colour = (READ_ROM(&image[0x00]) |
+                      (READ_ROM(&image[0x01]) << 0x08));
+            image += 0x02;
+            writeRun(colour, 0x01);
+         }
+      }
+      else
+      {
+         count = ((token & 0x3F) + 0x01);
+         writeRun(backColour, count);
+      }
+
+      total -= count;
+   }
+
+   SSD1289_SET_CS(true);
+   shadow.valid &= (~SHADOW_CURSOR);
+}
+
+
+/* Set display window (RAM address wrap region) of size (width, height).
+ *
+ * INPUT : x - X coordinate
+ *         y - Y coordinate
+ *         width - width of window
+ *         height - height of window
+ *
+ * OUTPUT: [None]
+ */
+void setWindow(const unsigned int x, const unsigned char y,
+               const unsigned int width, const unsigned char height)
+{
+   setShadowRegister(SHADOW_WINDOW_HS, x);
+   setShadowRegister(SHADOW_WINDOW_HE, x + (width - 0x01));
+   setShadowRegister(SHADOW_WINDOW_V,
+                     (((unsigned int)y + (height - 0x01)) << 0x08) | y);
+}
+
+
+/* Set display cursor (RAM address), ensuring it's within display window (as
+ * window is only restored when needed).
+ *
+ * INPUT : x - X coordinate
+ *         y - Y coordinate
+ *
+ * OUTPUT: [None]
+ */
+void setCursor(const unsigned int x, const unsigned char y)
+{
+   if(((shadow.valid & SHADOW_WINDOW) != SHADOW_WINDOW) ||
+      (x < shadow.value[SHADOW_WINDOW_HS]) ||
+      (x > shadow.value[SHADOW_WINDOW_HE]) ||
+      (y < (unsigned char)shadow.value[SHADOW_WINDOW_V]) ||
+      (y > (unsigned char)(shadow.value[SHADOW_WINDOW_V] >> 0x08)))
+   {
+      setWindow(0x00, 0x00, 0x0140, 0xF0);
+   }
+
+   setShadowRegister(SHADOW_CURSOR_X, x);
+   setShadowRegister(SHADOW_CURSOR_Y, y);
+}
+
+
+/* Set shadowed display register (only written if value differs from last).
+ *
+ * INPUT : index - shadow index of register
+ *         val - value to write to register
+ *
+ * OUTPUT: [None]
+ */
+void setShadowRegister(const unsigned char index, const unsigned int val)
+{
+   if((shadow.valid & SHADOW_BIT(index)) &&
+      (shadow.value[index] == val))
+   {
+      return;
+   }
+
+   setRegisterValue(shadowRegister[index], val);
+   shadow.value[index] = val;
+   shadow.valid |= SHADOW_BIT(index);
 }
 
 
@@ -248,39 +478,52 @@ void setRegisterValue(const unsigned char reg, const unsigned int val)
 }
 
 
-/* Read value from current register.
+/* Read values from current register (after dummy read), CS is held LOW for
+ * the whole stream.
  *
- * INPUT : [None]
+ * INPUT : count - number of values to read
  *
- * OUTPUT: [Return] - current register value
+ * OUTPUT: data - values read
  */
-unsigned int readValue(void)
+void readValues(unsigned int *data, unsigned long count)
 {
-   unsigned int data;
-   unsigned int last = 0x00;
-
    SSD1289_SET_RS(true);
    SSD1289_SET_RD(true);
    SSD1289_SET_WR(true);
    SSD1289_SET_DATA_INPUT(true);
-   Platform_RepeatNS(&last, 0x1F4);
-   /*Dummy read*/
+   Platform_HoldNS(0x01F4, 0x03 * PLATFORM_PIN_CYCLES);
    SSD1289_SET_CS(false);
-   SSD1289_SET_RD(false);
-   Platform_SleepNS(0xFA);
-   SSD1289_GET_DATA16();
-   Platform_SleepNS(0xFA);
+
+   /*Dummy read*/
+   readData();
+   while(count--)
+   {
+      *data++ = readData();
+   }
+
    SSD1289_SET_CS(true);
-   SSD1289_SET_RD(true);
-   /*Actual read*/
-   Platform_SleepNS(0x01F4);
-   SSD1289_SET_CS(false);
+   SSD1289_SET_DATA_INPUT(false);
+}
+
+
+/* Read 16-bit data from display (CS must be LOW).
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [Return] - data read
+ */
+unsigned int readData(void)
+{
+   unsigned int data;
+
+   /*Data is sampled without counting the input synchronizer, pin changes
+     count towards the following phase*/
    SSD1289_SET_RD(false);
-   Platform_SleepNS(0xFA);
+   Platform_HoldNS(0xFA, 0x00);
    data = SSD1289_GET_DATA16();
-   Platform_SleepNS(0xFA);
-   SSD1289_SET_CS(true);
-   SSD1289_SET_DATA_INPUT(false);
+   Platform_HoldNS(0xFA, PLATFORM_PIN_CYCLES);
+   SSD1289_SET_RD(true);
+   Platform_HoldNS(0x01F4, PLATFORM_PIN_CYCLES);
 
    return data;
 }
@@ -307,14 +550,73 @@ void writeValue(const unsigned int val)
  */
 void writeData(const unsigned int data)
 {
-   static unsigned int last = 0x00;
-
    SSD1289_SET_RD(true);
    SSD1289_SET_WR(true);
-   Platform_RepeatNS(&last, 0x32);
+   Platform_HoldNS(0x32, 0x02 * PLATFORM_PIN_CYCLES);
    SSD1289_SET_CS(false);
    SSD1289_SET_DATA16(data);
    SSD1289_SET_WR(false);
-   Platform_SleepNS(0x32);
+   Platform_HoldNS(0x32, PLATFORM_PIN_CYCLES);
+   SSD1289_SET_CS(true);
+}
+
+
+/* Write value to current register repeatedly (data lines are held, only WR
+ * is pulsed for each repeat).
+ *
+ * INPUT : val - value to write to current register
+ *         count - number of times to write value
+ *
+ * OUTPUT: [None]
+ */
+void burstValue(const unsigned int val, unsigned long count)
+{
+   if(count == 0x00)
+   {
+      return;
+   }
+
+   SSD1289_SET_RS(true);
+   writeData(val);
+   SSD1289_SET_WR(true);
+   SSD1289_SET_CS(false);
+   SSD1289_PULSE_WR(count - 0x01);
    SSD1289_SET_CS(true);
 }
+
+
+/* Write run of data to display (CS must be LOW and WR HIGH).
+ *
+ * INPUT : data - data to write
+ *         count - number of times to write data
+ *
+ * OUTPUT: [None]
+ */
+void writeRun(const unsigned int data, const unsigned int count)
+{
+   if(count)
+   {
+      SSD1289_SET_DATA16(data);
+      SSD1289_PULSE_WR(count);
+   }
+}
+
+
+#if defined(SSD1289_GENERIC_PULSE_WR)
+/* Pulse WR (write latched data again) using interface macros.
+ *
+ * INPUT : count - number of WR pulses
+ *
+ * OUTPUT: [None]
+ */
+void pulseWR(unsigned long count)
+{
+   while(count--)
+   {
+      SSD1289_SET_WR(false);
+      Platform_HoldNS(0x32, PLATFORM_PIN_CYCLES);
+      SSD1289_SET_WR(true);
+      Platform_HoldNS(0x32, PLATFORM_PIN_CYCLES);
+   }
+}
+#endif
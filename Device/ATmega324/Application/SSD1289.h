@@ -19,11 +19,17 @@ void SSD1289_Close(void);
 void SSD1289_SetPixel(const unsigned int, const unsigned char,
                       const unsigned int);
 unsigned int SSD1289_GetPixel(const unsigned int, const unsigned char);
+void SSD1289_ReadRect(const unsigned int, const unsigned char,
+                      const unsigned int, const unsigned char, unsigned int *);
 void SSD1289_FillRect(const unsigned int, const unsigned char,
                       const unsigned int, const unsigned char,
                       const unsigned int);
 void SSD1289_WriteString(const unsigned int, const unsigned char,
                          const char *restrict, const unsigned int,
                          const unsigned int);
+void SSD1289_GetImageSize(const unsigned char *, unsigned int *,
+                          unsigned char *);
+void SSD1289_DrawImage(const unsigned int, const unsigned char,
+                       const unsigned char *, const unsigned int);
 
 #endif
@@ -5,13 +5,17 @@
 /*Description: Bootloader for CNC primary controller device. When jumper/PB is*/
 /*             GND device may receive (via I2C/BCP) request to write main     */
 /*             application section. If jumper is left pulled-up main          */
-/*             application is started immediately.                            */
+/*             application is started immediately (if application integrity   */
+/*             is verified, otherwise bootloader remains active).             */
 /******************************************************************************/
 #include <string.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <avr/boot.h>
 #include <avr/pgmspace.h>
+#include <avr/eeprom.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
 #include <util/delay.h>
 #include "BCP.h"
 #include "TWI.h"
@@ -22,6 +26,41 @@
 #define FLASH_PAGE_MASK (0xFF80)
 #define FLASH_END       (0x8000)
 
+/*Application integrity trailer (length and CRC16 of application, written on
+  commit) is stored at end of application section, verified state is cached
+  in last byte of EEPROM*/
+#define APP_TRAILER       (0x6FFC)
+#define APP_VERIFIED_FLAG ((uint8_t *)E2END)
+#define APP_VERIFIED      (0xA5)
+
+/*Page programming (SPM) states*/
+#define SPM_IDLE  (0x00)
+#define SPM_ERASE (0x01)
+#define SPM_WRITE (0x02)
+
+/*BCP address space regions (bank in upper 32-bits of address, region offset
+  and size within bank in lower 32-bits):
+  0x00000000_00000000-0x00000000_00007FFF - FLASH (application section R/W)
+  0x00000001_00000000-0x00000001_000003FE - EEPROM (last byte reserved)
+  0x00000002_00000000-0x00000002_000008FF - SRAM/IO data space (read-only)
+  0x010000AC_E0000010                     - Lock(0x00)/Unlock(0x01) FLASH
+  0xFFFFFFFF_FFFFFFF6-0xFFFFFFFF_FFFFFFFF - Pages skipped, pages written,
+                                            "BOOTLOAD" ID (read-only)*/
+#define BANK_FLASH     (0x00000000UL)
+#define BANK_EEPROM    (0x00000001UL)
+#define BANK_SRAM      (0x00000002UL)
+#define BANK_CONTROL   (0x010000ACUL)
+#define BANK_INFO      (0xFFFFFFFFUL)
+#define REGION_CONTROL (0xE0000010UL)
+#define REGION_INFO    (0xFFFFFFF6UL)
+
+/*Export table (read by application at startup to discover bootloader
+  exports), layout version changes only when existing entries move or change
+  signature (new entries are appended and increase count)*/
+#define EXPORT_MAGIC   (0xB0E7)
+#define EXPORT_VERSION (0x01)
+#define EXPORT_COUNT   (0x06)
+
 /*General flags*/
 #define FLAG_TWI_INT        (0x01)
 #define FLAG_PRGRM_UNLOCKED (0x02)
@@ -29,32 +68,78 @@
 
 /*Global variables*/
 unsigned int writeAddress;
-unsigned char writeCount;
+unsigned int writeEnd;
 unsigned char writeBuffer[FLASH_PAGE_SIZE];
-unsigned char bootMsg[0x08] = {'B', 'O', 'O','T', 'L', 'O', 'A', 'D'};
+unsigned char writeMask[FLASH_PAGE_SIZE / 0x08];
+unsigned int spmAddress;
+unsigned char spmState = SPM_IDLE;
 volatile unsigned char flags = 0x00;
+struct
+{
+   unsigned char skipCount;
+   unsigned char writeCount;
+   unsigned char bootMsg[0x08];
+} info = {0x00, 0x00, {'B', 'O', 'O','T', 'L', 'O', 'A', 'D'}};
+
+bool flashRead(unsigned int, unsigned char *, unsigned char);
+bool flashWrite(unsigned int, unsigned char *, unsigned char);
+bool eepromRead(unsigned int, unsigned char *, unsigned char);
+bool eepromWrite(unsigned int, unsigned char *, unsigned char);
+bool sramRead(unsigned int, unsigned char *, unsigned char);
+bool infoRead(unsigned int, unsigned char *, unsigned char);
+bool controlWrite(unsigned int, unsigned char *, unsigned char);
+
+/*BCP address space region dispatch table (bank, start within bank and offset
+  of last byte in region)*/
+const struct memRegion
+{
+   unsigned long bank;
+   unsigned long start;
+   unsigned int last;
+   bool (*read)(unsigned int, unsigned char *, unsigned char);
+   bool (*write)(unsigned int, unsigned char *, unsigned char);
+} regions[] =
+{
+   {BANK_FLASH, 0x00, (FLASH_END - 0x01), flashRead, flashWrite},
+   {BANK_EEPROM, 0x00, (E2END - 0x01), eepromRead, eepromWrite},
+   {BANK_SRAM, 0x00, RAMEND, sramRead, NULL},
+   {BANK_CONTROL, REGION_CONTROL, 0x00, NULL, controlWrite},
+   {BANK_INFO, REGION_INFO, 0x09, infoRead, NULL}
+};
 
 
-/* Read data from I2C bus (used for BCP).
+/* Wait for I2C transfer in progress to complete.
  *
- * INPUT : data - output buffer for read data
- *         size - size of data to be read
+ * INPUT : [None]
  *
  * OUTPUT: [Return] - true if an error occurred, false otherwise
  */
-bool devRead(void *data, unsigned char size)
+bool devWait(void)
 {
    unsigned char remaining;
 
-   /*Read data for I2C bus*/
-   if(!TWI_StartRead(I2C_ADDRESS, data, size))
+   while(!TWI_Poll(&remaining));
+   if(remaining)
    {
       return true;
    }
 
-   /*Wait for read operation to complete*/
-   while(!TWI_Poll(&remaining));
-   if(remaining)
+   return false;
+}
+
+
+/* Read data from I2C bus (used for BCP).
+ *
+ * INPUT : data - output buffer for read data
+ *         size - size of data to be read
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool devRead(void *data, unsigned char size)
+{
+   /*Read data for I2C bus (and wait for read operation to complete)*/
+   if((!TWI_StartRead(I2C_ADDRESS, data, size)) ||
+      (devWait()))
    {
       return true;
    }
@@ -72,214 +157,531 @@ bool devRead(void *data, unsigned char size)
  */
 bool devWrite(void *data, unsigned char size)
 {
-   unsigned char remaining;
-
-   /*Write data to I2C bus*/
-   if(!TWI_StartWrite(I2C_ADDRESS, data, size))
+   /*Write data to I2C bus (and wait for write operation to complete)*/
+   if((!TWI_StartWrite(I2C_ADDRESS, data, size)) ||
+      (devWait()))
    {
       return true;
    }
 
-   /*Wait for write operation to complete*/
-   while(!TWI_Poll(&remaining));
-   if(remaining)
+   return false;
+}
+
+
+/* Advance page programming in progress (without blocking). Page erase is
+ * followed by page write, after which application FLASH memory is re-enabled
+ * for reading.
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void pageService(void)
+{
+   if((spmState == SPM_IDLE) ||
+      (boot_spm_busy()))
    {
-      return true;
+      return;
    }
 
-   return false;
+   /*SPM sequences are timed and must not be interrupted*/
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      if(spmState == SPM_ERASE)
+      {
+         boot_page_write(spmAddress);
+         spmState = SPM_WRITE;
+      }
+      else
+      {
+         boot_rww_enable();
+         spmState = SPM_IDLE;
+      }
+   }
 }
 
 
-/* Read FLASH memory page into temp-buffer.
+/* Wait for page programming in progress to complete.
  *
- * INPUT : addr - address of flash page to load
+ * INPUT : [None]
  *
  * OUTPUT: [None]
  */
-void readPage(unsigned int addr)
+void pageWait(void)
 {
-   unsigned char i;
-
-   for(i = 0x00; i < FLASH_PAGE_SIZE; i++)
+   while(spmState != SPM_IDLE)
    {
-      writeBuffer[i] = pgm_read_byte(addr + i);
+      pageService();
    }
 }
 
 
-/* Write buffer page to FLASH memory.
+/* Start programming buffer page to FLASH memory. Buffer is copied to SPM
+ * temp-buffer (bytes not written are merged from current FLASH contents) and
+ * page erase is started, leaving buffer free to receive next page while page
+ * is programmed in the background (see pageService()). Pages identical to
+ * FLASH are skipped and the erase is skipped if only bits that are set in
+ * FLASH need to be cleared.
  *
- * INPUT : addr - address of flash page to write
+ * INPUT : [None]
  *
  * OUTPUT: [None]
  */
-void writePage(unsigned int addr)
+void writePage(void)
 {
    unsigned char i;
+   unsigned char current;
+   bool changed = false;
+   bool erase = false;
    uint16_t writeWord;
+   unsigned int addr = (writeAddress & FLASH_PAGE_MASK);
+
+   flags &= (~FLAG_OUTSTANDING);
 
-   if(writeCount != 0xFF)
+   /*SPM temp-buffer (and FLASH for reading) only available once idle*/
+   pageWait();
+   eeprom_busy_wait();
+
+   /*Merge buffer with and compare against FLASH*/
+   for(i = 0x00; i < FLASH_PAGE_SIZE; i++)
    {
-      writeCount++;
+      current = pgm_read_byte(addr + i);
+      if(!(writeMask[i / 0x08] & _BV(i % 0x08)))
+      {
+         writeBuffer[i] = current;
+      }
+      else if(writeBuffer[i] != current)
+      {
+         changed = true;
+         if(writeBuffer[i] & (~current))
+         {
+            erase = true;
+         }
+      }
    }
+   memset(writeMask, 0x00, sizeof(writeMask));
 
-   flags &= (~FLAG_OUTSTANDING);
+   if(!changed)
+   {
+      if(info.skipCount != 0xFF)
+      {
+         info.skipCount++;
+      }
+      return;
+   }
 
-   /*Erase page*/
-   boot_page_erase(addr);
-   boot_spm_busy_wait();
+   if(info.writeCount != 0xFF)
+   {
+      info.writeCount++;
+   }
 
    /*Fill temp-buffer*/
    for(i = 0x00; i < FLASH_PAGE_SIZE; i += 0x02)
    {
       writeWord = writeBuffer[i];
       writeWord |= (((uint16_t)writeBuffer[i + 0x01]) << 0x08);
-      boot_page_fill(addr + i, writeWord);
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      {
+         boot_page_fill(addr + i, writeWord);
+      }
    }
 
-   /*Write temp-buffer to FLASH*/
-   boot_page_write(addr);
-   boot_spm_busy_wait();
-
-   /*Re-enable application FLASH memory for reading*/
-   boot_rww_enable();
+   /*Erase page (temp-buffer written to FLASH once erase completes) or write
+     page directly*/
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      if(erase)
+      {
+         boot_page_erase(addr);
+         spmState = SPM_ERASE;
+      }
+      else
+      {
+         boot_page_write(addr);
+         spmState = SPM_WRITE;
+      }
+   }
+   spmAddress = addr;
 }
 
 
-/* Process memory read commands.
+/* Write data to FLASH write-buffer (programming full pages).
  *
- * INPUT : addr - address for read
- *         data - output buffer for read data
- *         size - size of data to be read
+ * INPUT : offset - FLASH address to write
+ *         data - input buffer for write data
+ *         size - size of data to be written
  *
- * OUTPUT: [Return] - true if an error occurred, false otherwise
+ * OUTPUT: [None]
  */
-bool memRead(unsigned long long addr, void *data, unsigned char size)
+void bufferWrite(unsigned int offset, unsigned char *data, unsigned char size)
 {
-   unsigned char offset;
-   unsigned char *buf = data;
+   unsigned char i;
+   unsigned char page;
 
-   /*Last 8 bytes make up 8 byte string ID*/
-   if(addr >= 0xFFFFFFFFFFFFFFF8ULL)
+   /*Flush write-buffer if new address is outside page of last address*/
+   if((flags & FLAG_OUTSTANDING) &&
+      ((offset & FLASH_PAGE_MASK) != (writeAddress & FLASH_PAGE_MASK)))
    {
-      offset = (addr & 0x07);
-      if(size > (0x08 - offset))
+      writePage();
+   }
+   writeAddress = offset;
+
+   /*Modify page in buffer (programming full pages)*/
+   for(i = 0x00; i < size; i++)
+   {
+      flags |= FLAG_OUTSTANDING;
+      page = (writeAddress % FLASH_PAGE_SIZE);
+      writeBuffer[page] = data[i];
+      writeMask[page / 0x08] |= _BV(page % 0x08);
+
+      if(page == (FLASH_PAGE_SIZE - 0x01))
       {
-         return true;
+         writePage();
       }
-
-      memcpy(data, bootMsg + offset, size);
-      return false;
+      writeAddress++;
    }
-   /*Return pages written since last commit*/
-   else if((addr == 0xFFFFFFFFFFFFFFF7ULL) &&
-           (size == 0x01))
+}
+
+
+/* Calculate CRC16 (CCITT) of application section.
+ *
+ * INPUT : length - length of application
+ *
+ * OUTPUT: [Return] - CRC value
+ */
+uint16_t appCRC(unsigned int length)
+{
+   unsigned int i;
+   uint16_t crc = 0xFFFF;
+
+   for(i = 0x00; i < length; i++)
    {
-      buf[0x00] = writeCount;
-      return false;
+      crc = _crc_ccitt_update(crc, pgm_read_byte(i));
    }
 
-   /*FLASH memory is mapped into bottom of address space*/
-   if(addr < (unsigned long long)FLASH_END)
+   return crc;
+}
+
+
+/* Check application integrity against stored trailer (if not already
+ * verified since last commit).
+ *
+ * INPUT : [None]
+ *
+ * OUTPUT: [Return] - true if application is intact, false otherwise
+ */
+bool appVerify(void)
+{
+   unsigned int length;
+
+   if(eeprom_read_byte(APP_VERIFIED_FLAG) == APP_VERIFIED)
    {
-      for(offset = 0x00; offset < size; offset++)
-      {
-         buf[offset] = pgm_read_byte((uint16_t)addr + offset);
-      }
+      return true;
+   }
 
+   length = pgm_read_word(APP_TRAILER);
+   if((length == 0x00) ||
+      (length > APP_TRAILER) ||
+      (pgm_read_word(APP_TRAILER + 0x02) != appCRC(length)))
+   {
       return false;
    }
 
+   eeprom_update_byte(APP_VERIFIED_FLAG, APP_VERIFIED);
    return true;
 }
 
 
-/* Process memory write commands.
+/* Write application integrity trailer (for application written since
+ * unlock, or previous application length if larger, as a partial reflash
+ * leaves the remainder of the previous application in place) and mark
+ * application verified.
  *
- * INPUT : addr - address for write
+ * INPUT : [None]
+ *
+ * OUTPUT: [None]
+ */
+void appCommit(void)
+{
+   unsigned int length;
+   uint16_t trailer[0x02];
+
+   length = pgm_read_word(APP_TRAILER);
+   if((length < writeEnd) ||
+      (length > APP_TRAILER))
+   {
+      length = writeEnd;
+   }
+
+   trailer[0x00] = length;
+   trailer[0x01] = appCRC(length);
+
+   /*Trailer ends page, so page is programmed once trailer is buffered*/
+   bufferWrite(APP_TRAILER, (unsigned char *)trailer, sizeof(trailer));
+   pageWait();
+
+   eeprom_update_byte(APP_VERIFIED_FLAG, APP_VERIFIED);
+}
+
+
+/* Read FLASH memory region.
+ *
+ * INPUT : offset - offset into region
+ *         data - output buffer for read data
+ *         size - size of data to be read
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool flashRead(unsigned int offset, unsigned char *data, unsigned char size)
+{
+   /*Application FLASH memory can't be read while being programmed*/
+   pageWait();
+   while(size--)
+   {
+      *data++ = pgm_read_byte(offset++);
+   }
+
+   return false;
+}
+
+
+/* Write FLASH memory region (application section only, excluding trailer).
+ *
+ * INPUT : offset - offset into region
  *         data - input buffer for write data
  *         size - size of data to be written
  *
  * OUTPUT: [Return] - true if an error occurred, false otherwise
  */
-bool memWrite(unsigned long long addr, void *data, unsigned char size)
+bool flashWrite(unsigned int offset, unsigned char *data, unsigned char size)
 {
-   unsigned char i;
-   unsigned char *buf = data;
-   bool ret = true;
+   if(((offset + size) > APP_TRAILER) ||
+      (!(flags & FLAG_PRGRM_UNLOCKED)))
+   {
+      return true;
+   }
 
-   cli();
+   if((offset + size) > writeEnd)
+   {
+      writeEnd = (offset + size);
+   }
+   bufferWrite(offset, data, size);
+
+   return false;
+}
+
+
+/* Read EEPROM memory region.
+ *
+ * INPUT : offset - offset into region
+ *         data - output buffer for read data
+ *         size - size of data to be read
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool eepromRead(unsigned int offset, unsigned char *data, unsigned char size)
+{
+   eeprom_read_block(data, (const void *)offset, size);
+
+   return false;
+}
+
+
+/* Write EEPROM memory region (EEPROM can't be written while a FLASH page is
+ * being programmed).
+ *
+ * INPUT : offset - offset into region
+ *         data - input buffer for write data
+ *         size - size of data to be written
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool eepromWrite(unsigned int offset, unsigned char *data, unsigned char size)
+{
+   pageWait();
+   eeprom_update_block(data, (void *)offset, size);
+
+   return false;
+}
 
-   /*Lock/Unlock/Commit application memory*/
-   if((addr == 0x010000ACE0000010ULL) &&
-      (size == 0x01))
+
+/* Read SRAM (data space, including registers and I/O) memory region.
+ *
+ * INPUT : offset - offset into region
+ *         data - output buffer for read data
+ *         size - size of data to be read
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool sramRead(unsigned int offset, unsigned char *data, unsigned char size)
+{
+   while(size--)
    {
-      if(buf[0x00] == 0x00)
-      {
-         /*If data is still in temp-write buffer, flush to FLASH*/
-         if(flags & FLAG_OUTSTANDING)
-         {
-            writePage(writeAddress - (writeAddress % FLASH_PAGE_SIZE));
-         }
+      *data++ = *((volatile unsigned char *)offset++);
+   }
 
-         flags &= (~FLAG_PRGRM_UNLOCKED);
-      }
-      else if(buf[0x00] == 0x01)
+   return false;
+}
+
+
+/* Read bootloader information region (pages skipped, pages written since
+ * last commit and 8 byte string ID).
+ *
+ * INPUT : offset - offset into region
+ *         data - output buffer for read data
+ *         size - size of data to be read
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool infoRead(unsigned int offset, unsigned char *data, unsigned char size)
+{
+   memcpy(data, ((unsigned char *)&info) + offset, size);
+
+   return false;
+}
+
+
+/* Lock/Unlock/Commit application memory.
+ *
+ * INPUT : offset - offset into region
+ *         data - input buffer for write data
+ *         size - size of data to be written
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool controlWrite(unsigned int offset, unsigned char *data, unsigned char size)
+{
+   if(data[0x00] == 0x00)
+   {
+      /*If data is still in write buffer, flush to FLASH*/
+      if(flags & FLAG_OUTSTANDING)
       {
-         flags |= FLAG_PRGRM_UNLOCKED;
-         flags &= (~FLAG_OUTSTANDING);
-         writeCount = 0x00;
-         writeAddress = 0x00;
-         readPage(writeAddress);
+         writePage();
       }
-      else
+      pageWait();
+
+      /*Application written, store integrity trailer*/
+      if((flags & FLAG_PRGRM_UNLOCKED) &&
+         (writeEnd))
       {
-         goto error;
+         appCommit();
       }
 
-      goto done;
+      flags &= (~FLAG_PRGRM_UNLOCKED);
    }
-
-   /*Bounds/state check*/
-   if((addr >= (unsigned long long)FLASH_END) ||
-      ((addr + size) >= (unsigned long long)FLASH_END) ||
-      (!(flags & FLAG_PRGRM_UNLOCKED)))
+   else if(data[0x00] == 0x01)
    {
-      goto error;
+      pageWait();
+
+      /*Application no longer verified until committed*/
+      eeprom_update_byte(APP_VERIFIED_FLAG, 0xFF);
+
+      flags |= FLAG_PRGRM_UNLOCKED;
+      flags &= (~FLAG_OUTSTANDING);
+      writeEnd = 0x00;
+      info.writeCount = 0x00;
+      info.skipCount = 0x00;
+      writeAddress = 0x00;
+      memset(writeMask, 0x00, sizeof(writeMask));
+   }
+   else
+   {
+      return true;
    }
 
-   /*Flush write-buffer if new address is outside page of last address*/
-   if(((unsigned int)addr & FLASH_PAGE_MASK) !=
-      (writeAddress & FLASH_PAGE_MASK))
+   return false;
+}
+
+
+/* Find memory region containing entire access (bank and offset are compared
+ * as 32-bit halves, as no region crosses a bank).
+ *
+ * INPUT : addr - address of access
+ *         size - size of access
+ *         offset - location to store offset of access into region
+ *
+ * OUTPUT: [Return] - region (NULL if no region contains access)
+ */
+const struct memRegion *findRegion(unsigned long long addr,
+                                   unsigned char size, unsigned int *offset)
+{
+   unsigned char i;
+   unsigned long bank = (unsigned long)(addr >> 0x20);
+   unsigned long low;
+
+   for(i = 0x00; i < (sizeof(regions) / sizeof(regions[0x00])); i++)
    {
-      if(flags & FLAG_OUTSTANDING)
+      /*Offset wraps (past region end) if below region start*/
+      low = ((unsigned long)addr - regions[i].start);
+      if((bank == regions[i].bank) &&
+         (low <= regions[i].last) &&
+         ((size - 0x01) <= (regions[i].last - (unsigned int)low)))
       {
-         writePage(writeAddress - (writeAddress % FLASH_PAGE_SIZE));
-         readPage((unsigned int)addr - ((unsigned int)addr % FLASH_PAGE_SIZE));
+         *offset = (unsigned int)low;
+         return &regions[i];
       }
    }
-   writeAddress = (unsigned int)addr;
 
-   /*Modify page in buffer*/
-   for(i = 0x00; i < size; i++)
+   return NULL;
+}
+
+
+/* Process memory read/write commands.
+ *
+ * INPUT : addr - address for access
+ *         data - buffer for read/write data
+ *         size - size of data to be read/written
+ *         write - true for write, false for read
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool memAccess(unsigned long long addr, void *data, unsigned char size,
+               bool write)
+{
+   unsigned int offset;
+   const struct memRegion *region = findRegion(addr, size, &offset);
+   bool (*access)(unsigned int, unsigned char *, unsigned char);
+
+   if(region == NULL)
    {
-      flags |= FLAG_OUTSTANDING;
-      writeBuffer[writeAddress % FLASH_PAGE_SIZE] = buf[i];
-      writeAddress++;
+      return true;
+   }
 
-      if(!(writeAddress % FLASH_PAGE_SIZE))
-      {
-         writePage(writeAddress - FLASH_PAGE_SIZE);
-         readPage(writeAddress);
-      }
+   access = (write) ? region->write : region->read;
+   if(access == NULL)
+   {
+      return true;
    }
 
-done:
-   ret = false;
-error:
-   sei();
-   return ret;
+   return access(offset, data, size);
+}
+
+
+/* Process memory read commands.
+ *
+ * INPUT : addr - address for read
+ *         data - output buffer for read data
+ *         size - size of data to be read
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool memRead(unsigned long long addr, void *data, unsigned char size)
+{
+   return memAccess(addr, data, size, false);
+}
+
+
+/* Process memory write commands.
+ *
+ * INPUT : addr - address for write
+ *         data - input buffer for write data
+ *         size - size of data to be written
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool memWrite(unsigned long long addr, void *data, unsigned char size)
+{
+   return memAccess(addr, data, size, true);
 }
 
 
@@ -312,6 +714,31 @@ void BCP_Init_wrapper(struct BCP_Session *bcp)
 }
 
 
+/*Versioned export table (EXPORT, located at fixed address 0x7FC0)*/
+const struct
+{
+   uint16_t magic;
+   uint8_t version;
+   uint8_t count;
+   uint16_t bcpSize;
+   void (*entries[EXPORT_COUNT])(void);
+} bootExportTable __attribute__((section(".bootexporttable"))) =
+{
+   EXPORT_MAGIC,
+   EXPORT_VERSION,
+   EXPORT_COUNT,
+   sizeof(struct BCP_Session),
+   {
+      (void (*)(void))TWI_ISR,
+      (void (*)(void))TWI_Poll,
+      (void (*)(void))TWI_StartWrite,
+      (void (*)(void))TWI_StartRead,
+      (void (*)(void))BCP_Init_wrapper,
+      (void (*)(void))BCP_HandleRequest
+   }
+};
+
+
 int main(void)
 {
    struct BCP_Session bcp;
@@ -332,9 +759,10 @@ int main(void)
    TWI_Initialize();
    BCP_OpenDevice(&bcp, devRead, devWrite);
 
-   if(PINB & 0x01)
+   if((PINB & 0x01) &&
+      (appVerify()))
    {
-      /*PB on pin not GND'd, jump to application*/
+      /*PB on pin not GND'd (and application intact), jump to application*/
       asm("jmp 0x00");
    }
 
@@ -347,8 +775,10 @@ int main(void)
    MCUCR = 0x02;
 
    sei();
+
    for(;;)
    {
+      pageService();
       if(flags & FLAG_TWI_INT)
       {
          BCP_HandleRequest(&bcp, memRead, memWrite);
@@ -14,6 +14,7 @@
 #define TWI_AddressL R3
 #define TWI_AddressH R4
 #define TWI_Size     R5
+#define TWI_Address  R6
 #else
 #include <stdbool.h>
 #include <stdint.h>
@@ -23,6 +24,7 @@ register uint8_t TWI_Flags    asm("r2");
 register uint8_t TWI_AddressL asm("r3");
 register uint8_t TWI_AddressH asm("r4");
 register uint8_t TWI_Size     asm("r5");
+register uint8_t TWI_Address  asm("r6");
 
 void TWI_ISR(void);
 bool TWI_Initialize(void);
@@ -0,0 +1,236 @@
+/******************************************************************************/
+/*Filename:    Dump.c                                                         */
+/*Project:     CNC 1                                                          */
+/*Author:      New Rupture Systems                                            */
+/*Description: Definitions for device memory dumping library utility         */
+/*             functions.                                                     */
+/******************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "BCP.h"
+#include "IHex.h"
+#include "Dump.h"
+
+/*Size of data buffered before being written to output file*/
+#define BLOCK_SIZE (0x0100)
+
+static bool writeBlock(struct Dump_Session *restrict, unsigned long long,
+                       const unsigned char *restrict, unsigned long);
+
+
+/* Initialize dump library interface. Output file is written as raw binary if
+ * filename ends in ".bin", otherwise as Intel HEX.
+ *
+ * INPUT : dump - Dump_Session handle
+ *         bcp - BCP_Session handle
+ *         filename - name of output file to create
+ *         address - device (BCP) address to start reading from
+ *         size - size of memory to read
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool Dump_Open(struct Dump_Session *restrict dump,
+               struct BCP_Session *restrict bcp,
+               const char *restrict filename, unsigned long long address,
+               unsigned long size)
+{
+   const char *ext = strrchr(filename, '.');
+
+   if(size == 0x00)
+   {
+      dump->error = 0x01;
+      return true;
+   }
+
+   dump->raw = NULL;
+   if((ext != NULL) &&
+      ((strcmp(ext, ".bin") == 0x00) ||
+       (strcmp(ext, ".BIN") == 0x00)))
+   {
+      dump->raw = fopen(filename, "wb");
+      if(dump->raw == NULL)
+      {
+         dump->error = 0x00;
+         return true;
+      }
+   }
+   else
+   {
+      /*Intel HEX only supports 32-bit addresses*/
+      if((address + (size - 0x01)) > 0xFFFFFFFFULL)
+      {
+         dump->error = 0x01;
+         return true;
+      }
+
+      if(IHex_Create(&dump->file, filename))
+      {
+         dump->error = 0x00;
+         return true;
+      }
+   }
+
+   dump->bcp = bcp;
+   dump->address = address;
+   dump->size = size;
+   return false;
+}
+
+
+/* Close dump library interface.
+ *
+ * INPUT : dump - Dump_Session handle
+ *
+ * OUTPUT: [None]
+ */
+void Dump_Close(struct Dump_Session *restrict dump)
+{
+   if(dump->raw != NULL)
+   {
+      fclose(dump->raw);
+   }
+   else
+   {
+      IHex_Close(&dump->file);
+   }
+}
+
+
+/* Retrieve error code for Dump_Session.
+ *
+ * INPUT : dump - Dump_Session handle
+ *
+ * OUTPUT: [Return] - error code
+ */
+unsigned int Dump_GetError(struct Dump_Session *restrict dump)
+{
+   return dump->error;
+}
+
+
+/* Retrieve error code string for Dump_Session.
+ *
+ * INPUT : dump - Dump_Session handle
+ *
+ * OUTPUT: [Return] - error code string
+ */
+const char *Dump_GetErrorString(struct Dump_Session *restrict dump)
+{
+   const char *lookup[] =
+   {
+      "Unable to create output file",
+      "Invalid address range for output file",
+      "Failed setup for read",
+      "Device Read/Address error",
+      "Unable to write output file"
+   };
+
+   return lookup[dump->error];
+}
+
+
+/* Read device memory range into output file. Device address auto-increment is
+ * used so only a single address request is made for the entire range.
+ *
+ * INPUT : dump - Dump_Session handle
+ *         update - callback update function
+ *         rate - rate to call update function (in percent)
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool Dump_Read(struct Dump_Session *restrict dump, void (*update)(),
+               const unsigned char rate)
+{
+   unsigned char block[BLOCK_SIZE];
+   unsigned char sent;
+   unsigned long long address = dump->address;
+   unsigned long remaining = dump->size;
+   unsigned long blockSize = 0x00;
+   unsigned long rwSize = 0x00;
+   unsigned char updates = 0x00;
+
+   /*Setup*/
+   if((BCP_SetAddress(dump->bcp, address)) ||
+      (BCP_SetFlags(dump->bcp, FLAG_ADDR_INC)))
+   {
+      dump->error = 0x02;
+      return true;
+   }
+
+   while(remaining)
+   {
+      sent = (remaining > 0x08) ? 0x08 : remaining;
+      if(BCP_ReadMemory(dump->bcp, block + blockSize, sent))
+      {
+         dump->error = 0x03;
+         return true;
+      }
+
+      blockSize += sent;
+      remaining -= sent;
+      rwSize += sent;
+
+      /*Flush block to output file when full (or done)*/
+      if((blockSize > (BLOCK_SIZE - 0x08)) ||
+         (!remaining))
+      {
+         if(writeBlock(dump, address, block, blockSize))
+         {
+            dump->error = 0x04;
+            return true;
+         }
+
+         address += blockSize;
+         blockSize = 0x00;
+      }
+
+      if(rate != 0x00)
+      {
+         /*Callback progress update function*/
+         while(updates != (((rwSize * 0x64) / dump->size) / rate))
+         {
+            update();
+            updates++;
+         }
+      }
+   }
+
+   /*Terminate output file*/
+   if(dump->raw != NULL)
+   {
+      if(fflush(dump->raw))
+      {
+         dump->error = 0x04;
+         return true;
+      }
+   }
+   else if(IHex_PutEnd(&dump->file))
+   {
+      dump->error = 0x04;
+      return true;
+   }
+
+   return false;
+}
+
+
+/* Write block of read memory to output file.
+ *
+ * INPUT : dump - Dump_Session handle
+ *         address - device address of block
+ *         data - block data
+ *         size - size of block
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool writeBlock(struct Dump_Session *restrict dump, unsigned long long address,
+                const unsigned char *restrict data, unsigned long size)
+{
+   if(dump->raw != NULL)
+   {
+      return (fwrite(data, 0x01, size, dump->raw) != size);
+   }
+
+   return IHex_PutData(&dump->file, (unsigned long)address, data, size);
+}
@@ -0,0 +1,33 @@
+/******************************************************************************/
+/*Filename:    Dump.h                                                         */
+/*Project:     CNC 1                                                          */
+/*Author:      New Rupture Systems                                            */
+/*Description: Device memory dumping (read-back) library utilities.           */
+/******************************************************************************/
+#ifndef DUMP_H
+#define DUMP_H
+#include <stdbool.h>
+#include <stdio.h>
+#include "IHex.h"
+#include "BCP.h"
+
+struct Dump_Session
+{
+   struct IHex_Session file;
+   FILE *raw;
+   struct BCP_Session *bcp;
+   unsigned long long address;
+   unsigned long size;
+   unsigned int error;
+};
+
+
+bool Dump_Open(struct Dump_Session *restrict, struct BCP_Session *restrict,
+               const char *restrict, unsigned long long, unsigned long);
+void Dump_Close(struct Dump_Session *restrict);
+bool Dump_Read(struct Dump_Session *restrict, void (*)(),
+               const unsigned char);
+unsigned int Dump_GetError(struct Dump_Session *restrict);
+const char *Dump_GetErrorString(struct Dump_Session *restrict);
+
+#endif
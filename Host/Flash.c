@@ -8,7 +8,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include "BCP.h"
-#include "IHex.h"
+#include "Image.h"
 #include "Flash.h"
 
 static bool writeVerify(struct Flash_Session *restrict, void (*)(),
@@ -19,20 +19,20 @@ static bool writeVerify(struct Flash_Session *restrict, void (*)(),
  *
  * INPUT : flash - Flash_Session handle
  *         bcp - BCP_Session handle
- *         filename - name of Intel HEX file to open
+ *         filename - name of image (Intel HEX, ELF, raw binary) file to open
+ *         offset - load address (raw binary image only)
  *
  * OUTPUT: [Return] - true if an error occurred, false otherwise
  */
 bool Flash_Open(struct Flash_Session *restrict flash,
                 struct BCP_Session *restrict bcp,
-                const char *restrict filename)
+                const char *restrict filename, unsigned long long offset)
 {
    unsigned char bcpBuffer[0x08];
-   unsigned long size;
    bool ret = true;
 
-   /*Open hex file to be flashed to device*/
-   if(IHex_Open(&flash->file, filename))
+   /*Open image file to be flashed to device*/
+   if(Image_Open(&flash->image, filename, offset))
    {
       flash->error = 0x00;
       return true;
@@ -57,17 +57,21 @@ bool Flash_Open(struct Flash_Session *restrict flash,
       goto closeFile;
    }
 
-   /*Get total hex file size*/
-   if(IHex_GetTotalSize(&flash->file, &size))
+   /*Get total image size*/
+   flash->size = Image_GetTotalSize(&flash->image);
+   if(flash->size == 0x00)
    {
       flash->error = 0x03;
       goto closeFile;
    }
-   
+
    flash->bcp = bcp;
-   flash->size = size;
    ret = false;
 closeFile:
+   if(ret)
+   {
+      Image_Close(&flash->image);
+   }
    return ret;
 }
 
@@ -80,7 +84,7 @@ closeFile:
  */
 void Flash_Close(struct Flash_Session *restrict flash)
 {
-   IHex_Close(&flash->file);
+   Image_Close(&flash->image);
 }
 
 
@@ -106,10 +110,10 @@ const char *Flash_GetErrorString(struct Flash_Session *restrict flash)
 {
    const char *lookup[] =
    {
-      "Unable to open Intel Hex file",
+      "Unable to open image file",
       "Device not in flash mode",
       "Unable to unlock device flash",
-      "Unable to retrieve hex file size",
+      "Image file contains no data",
       "Unable to retrieve pages written",
       "Failed setup for write/verify",
       "Failed to commit flash write",
@@ -124,13 +128,14 @@ const char *Flash_GetErrorString(struct Flash_Session *restrict flash)
 /* Get total size flashed.
  *
  * INPUT : flash - Flash_Session handle
- *         pages - size flashed in device pages
- *         bytes - size flashed in bytes
  *
- * OUTPUT: [Return] - true if an error occurred, false otherwise
+ * OUTPUT: pages - location to store size flashed in device pages
+ *         skipped - location to store pages skipped (already up to date)
+ *         bytes - location to store size flashed in bytes
+ *         [Return] - true if an error occurred, false otherwise
  */
 bool Flash_GetSize(struct Flash_Session *restrict flash, unsigned char *pages,
-                   unsigned int *bytes)
+                   unsigned char *skipped, unsigned int *bytes)
 {
    unsigned char bcpBuffer[0x08];
 
@@ -142,8 +147,17 @@ bool Flash_GetSize(struct Flash_Session *restrict flash, unsigned char *pages,
       flash->error = 0x04;
       return true;
    }
-
    *pages = bcpBuffer[0x00];
+
+   /*Attempt to get page skip count (not supported by older bootloaders)*/
+   bcpBuffer[0x00] = 0x00;
+   if((BCP_SetAddress(flash->bcp, 0xFFFFFFFFFFFFFFF6ULL)) ||
+      (BCP_ReadMemory(flash->bcp, bcpBuffer, 0x01)))
+   {
+      bcpBuffer[0x00] = 0x00;
+   }
+   *skipped = bcpBuffer[0x00];
+
    *bytes = flash->size;
    return false;
 }
@@ -192,53 +206,33 @@ bool Flash_Verify(struct Flash_Session *restrict flash, void (*cb)(),
 bool writeVerify(struct Flash_Session *restrict flash, void (*update)(),
                  const unsigned char rate, const bool verify)
 {
-   unsigned long address;
-   unsigned char dataSize;
-   unsigned char *data;
+   unsigned int i;
+   unsigned long long address;
+   unsigned long dataSize;
+   const unsigned char *data;
    unsigned char sent;
    unsigned char bcpBuffer[0x08];
-   unsigned long lastAddress = 0x00;
+   unsigned long long lastAddress = 0x00;
    unsigned long rwSize = 0x00;
    unsigned char updates = 0x00;
 
    /*Setup*/
-   if((IHex_Reset(&flash->file)) ||
-      (BCP_SetAddress(flash->bcp, 0x00)) ||
+   if((BCP_SetAddress(flash->bcp, 0x00)) ||
       (BCP_SetFlags(flash->bcp, FLAG_ADDR_INC)))
    {
       flash->error = 0x05;
       return true;
    }
 
-   /*Flash full Intel HEX file*/
-   while(0x01)
+   /*Flash all image segments*/
+   for(i = 0x00; i < Image_GetSegmentCount(&flash->image); i++)
    {
-      if(IHex_GetNextData(&flash->file, &address, &data, &dataSize))
+      if(Image_GetSegment(&flash->image, i, &address, &data, &dataSize))
       {
+         flash->error = 0x05;
          return true;
       }
 
-      if(data == NULL)
-      {
-         if(!verify)
-         {
-            /*Lock flash to ensure all previous writes are committed*/
-            bcpBuffer[0x00] = 0x00;
-            if((BCP_SetAddress(flash->bcp, 0x010000ACE0000010ULL)) ||
-               (BCP_WriteMemory(flash->bcp, bcpBuffer, 0x01)))
-            {
-               flash->error = 0x07;
-               return true;
-            }
-         }
-
-         return false;
-      }
-      else if(dataSize == 0x00)
-      {
-         continue;
-      }
-
       if(address != lastAddress)
       {
          if(BCP_SetAddress(flash->bcp, address))
@@ -291,4 +285,18 @@ bool writeVerify(struct Flash_Session *restrict flash, void (*update)(),
          }
       }
    }
+
+   if(!verify)
+   {
+      /*Lock flash to ensure all previous writes are committed*/
+      bcpBuffer[0x00] = 0x00;
+      if((BCP_SetAddress(flash->bcp, 0x010000ACE0000010ULL)) ||
+         (BCP_WriteMemory(flash->bcp, bcpBuffer, 0x01)))
+      {
+         flash->error = 0x07;
+         return true;
+      }
+   }
+
+   return false;
 }
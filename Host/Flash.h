@@ -7,12 +7,12 @@
 #ifndef FLASH_H
 #define FLASH_H
 #include <stdbool.h>
-#include "IHex.h"
+#include "Image.h"
 #include "BCP.h"
 
 struct Flash_Session
 {
-   struct IHex_Session file;
+   struct Image_Session image;
    struct BCP_Session *bcp;
    unsigned int size;
    unsigned int error;
@@ -20,10 +20,10 @@ struct Flash_Session
 
 
 bool Flash_Open(struct Flash_Session *restrict, struct BCP_Session *restrict,
-                const char *restrict);
+                const char *restrict, unsigned long long);
 void Flash_Close(struct Flash_Session *restrict);
 bool Flash_GetSize(struct Flash_Session *restrict, unsigned char *,
-                   unsigned int *);
+                   unsigned char *, unsigned int *);
 bool Flash_Write(struct Flash_Session *restrict, void (*)(),
                  const unsigned char);
 bool Flash_Verify(struct Flash_Session *restrict, void (*)(),
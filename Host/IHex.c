@@ -6,36 +6,122 @@
 /******************************************************************************/
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "Platform.h"
 #include "IHex.h"
 
 /*Intel HEX record min/max valid sizes*/
 #define MIN_RECORD_SIZE (0x0B)
 #define MAX_RECORD_SIZE (0x0208 + sizeof('\n'))
 
-/*Helper macro's*/
-#define NTOH16(x) swap16((x))
-#define NTOH32(x) swap32((x))
+/*Data bytes per record when writing*/
+#define PUT_RECORD_SIZE (0x10)
 
-union size16
+/*Hexadecimal character lookup table invalid flag*/
+#define HEX_INVALID (0x10)
+
+/*Bytes converted per block (SSE2)*/
+#define CONVERT_BLOCK_SIZE (0x10)
+
+/*Initial number of data runs allocated when parsing*/
+#define RUN_ALLOC_SIZE (0x40)
+
+/*Minimum file size per parse chunk (and maximum number of chunks)*/
+#define PARSE_CHUNK_MIN (0x00100000UL)
+#define PARSE_CHUNK_MAX (0x10)
+
+/*Run of contiguous data (in file order) referenced during parsing*/
+struct dataRun
 {
-   unsigned char u8[sizeof(unsigned int)];
-   unsigned int u16;
+   unsigned long address;
+   unsigned long size;
+   unsigned char *data;
+   unsigned int order;
+   unsigned int segment;
 };
 
-union size32
+/*Hexadecimal character value lookup (HEX_INVALID if not hexadecimal)*/
+static const unsigned char hexTable[0x0100] =
 {
-   unsigned char u8[sizeof(unsigned long)];
-   unsigned long u32;
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+   0x08, 0x09, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
 };
 
-static bool convertHex(const char *, void *, unsigned char);
-static unsigned int swap16(unsigned int);
-static unsigned long swap32(unsigned long);
+/*Chunk of file decoded by single thread*/
+struct parseChunk
+{
+   const char *start;
+   const char *end;
+   const char *fileEnd;
+   unsigned char *data;
+   unsigned char buffer[0x0100];
+   struct dataRun *runs;
+   unsigned int runCount;
+   unsigned int relativeCount;
+   bool addressOffsetSet;
+   unsigned long addressOffset;
+   bool startAddressSet;
+   unsigned long startAddress;
+   bool eof;
+   bool failed;
+   unsigned int error;
+   bool threadCreated;
+   Platform_Thread thread;
+};
+
+static bool parseFile(struct IHex_Session *restrict);
+static PLATFORM_THREAD(parseWorker, arg);
+static void parseChunk(struct parseChunk *restrict);
+static bool buildSegments(struct IHex_Session *restrict,
+                          struct dataRun *restrict, unsigned int);
+static int compareRuns(const void *, const void *);
+static bool convertHex(const char *, void *, unsigned int);
+#if defined(__SSE2__)
+static bool convertHexBlock(const unsigned char *, unsigned char *);
+#endif
+static bool putRecord(struct IHex_Session *restrict, unsigned char,
+                      unsigned int, const unsigned char *restrict,
+                      unsigned char);
 
 
-/* Open an Intel HEX file.
+/* Open an Intel HEX file. The file is memory mapped and all records are
+ * decoded in a single pass into an address ordered map of data segments
+ * (adjacent data is merged, later records take precedence over earlier ones
+ * where data overlaps).
  *
  * INPUT : ihex - IHex_Session handle
  *         filename - name of file to open
@@ -45,21 +131,62 @@ static unsigned long swap32(unsigned long);
 bool IHex_Open(struct IHex_Session *restrict ihex,
                const char *restrict filename)
 {
-   ihex->file = fopen(filename, "r");
+   ihex->file = NULL;
+   ihex->map = NULL;
+   ihex->data = NULL;
+   ihex->segments = NULL;
+   ihex->count = 0x00;
+   ihex->next = 0x00;
+   ihex->size = 0x00;
+   ihex->startAddressSet = false;
+   ihex->addressOffset = 0x00;
 
-   if(ihex->file == NULL)
+   if(Platform_MapFile(filename, &ihex->map, &ihex->mapSize))
    {
+      ihex->map = NULL;
       ihex->error = 0x00;
       return true;
    }
 
+   if(parseFile(ihex))
+   {
+      IHex_Close(ihex);
+      return true;
+   }
+
+   return false;
+}
+
+
+/* Create an Intel HEX file (for writing).
+ *
+ * INPUT : ihex - IHex_Session handle
+ *         filename - name of file to create
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool IHex_Create(struct IHex_Session *restrict ihex,
+                 const char *restrict filename)
+{
+   ihex->map = NULL;
+   ihex->data = NULL;
+   ihex->segments = NULL;
+   ihex->count = 0x00;
+   ihex->file = fopen(filename, "w");
+
+   if(ihex->file == NULL)
+   {
+      ihex->error = 0x07;
+      return true;
+   }
+
    ihex->startAddressSet = false;
    ihex->addressOffset = 0x00;
    return false;
 }
 
 
-/* Reset file (setting read position to 0).
+/* Reset file (setting read position to first data segment).
  *
  * INPUT : ihex - IHex_Session handle
  *
@@ -67,44 +194,22 @@ bool IHex_Open(struct IHex_Session *restrict ihex,
  */
 bool IHex_Reset(struct IHex_Session *restrict ihex)
 {
-   ihex->error = 0x01;
-   return fseek(ihex->file, 0x00, SEEK_SET);
+   ihex->next = 0x00;
+   return false;
 }
 
 
-/* Get total of all data records in file.
+/* Get total of all data in file (overlapping data counted once).
  *
  * INPUT : ihex - IHex_Session handle
  *
- * OUTPUT: [Return] - true if an error occurred, false otherwise
+ * OUTPUT: size - location to store size
+ *         [Return] - true if an error occurred, false otherwise
  */
 bool IHex_GetTotalSize(struct IHex_Session *restrict ihex,
                        unsigned long *restrict size)
 {
-   unsigned long address;
-   unsigned char *data;
-   unsigned char size2;
-
-   if(IHex_Reset(ihex))
-   {
-      return true;
-   }
-
-   *size = 0x00;
-   do
-   {
-      if(IHex_GetNextData(ihex, &address, &data, &size2))
-      {
-         return true;
-      }
-      *size += size2;
-   } while(data != NULL);
-
-   if(IHex_Reset(ihex))
-   {
-      return true;
-   }
-
+   *size = ihex->size;
    return false;
 }
 
@@ -130,221 +235,686 @@ bool IHex_GetStartAddress(struct IHex_Session *restrict ihex,
 }
 
 
-/* Retrieve data to write from next Intel HEX data record.
+/* Retrieve next data segment (segments are ordered by address and data
+ * remains valid until the file is closed).
  *
  * INPUT : ihex - IHex_Session handle
  *
  * OUTPUT: address - location to store address
- *         data - location to store location of data
+ *         data - location to store location of data (NULL if no more data)
  *         size - location to store data size
  *         [Return] - true if an error occurred, false otherwise
  */
 bool IHex_GetNextData(struct IHex_Session *restrict ihex,
                       unsigned long *restrict address,
-                      unsigned char **restrict data,
-                      unsigned char *restrict size)
+                      const unsigned char **restrict data,
+                      unsigned long *restrict size)
 {
-   unsigned char dataSize;
-   unsigned int dataAddress;
-   unsigned char recordType;
-   unsigned long check;
-   unsigned char check1;
-   unsigned char i;
+   if(ihex->next >= ihex->count)
+   {
+      *address = 0x00;
+      *data = NULL;
+      *size = 0x00;
+      return false;
+   }
 
-   while(0x01)
+   *address = ihex->segments[ihex->next].address;
+   *data = ihex->segments[ihex->next].data;
+   *size = ihex->segments[ihex->next].size;
+   ihex->next++;
+   return false;
+}
+
+
+/* Write data as Intel HEX data records (emitting extended linear address
+ * records as required).
+ *
+ * INPUT : ihex - IHex_Session handle
+ *         address - address of data
+ *         data - data to write
+ *         size - size of data
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool IHex_PutData(struct IHex_Session *restrict ihex, unsigned long address,
+                  const unsigned char *restrict data, unsigned long size)
+{
+   unsigned char offset[0x02];
+   unsigned long recordSize;
+
+   while(size)
    {
-      ihex->buffer[MIN_RECORD_SIZE - 0x01] = '\n';
-      ihex->buffer[MAX_RECORD_SIZE] = '\0';
-      if(fgets((char *)ihex->buffer, MAX_RECORD_SIZE + 0x01,
-               ihex->file) == NULL)
+      /*Set upper 16-bits of address (if changed)*/
+      if((address & 0xFFFF0000UL) != ihex->addressOffset)
       {
-         if(ferror(ihex->file))
+         ihex->addressOffset = (address & 0xFFFF0000UL);
+         offset[0x00] = (unsigned char)((ihex->addressOffset >> 0x18) & 0xFF);
+         offset[0x01] = (unsigned char)((ihex->addressOffset >> 0x10) & 0xFF);
+         if(putRecord(ihex, 0x04, 0x00, offset, 0x02))
          {
-            clearerr(ihex->file);
+            return true;
          }
+      }
 
-         ihex->error = 0x03;
-         return true;
+      /*Data record (must not cross 64K boundary)*/
+      recordSize = (size > PUT_RECORD_SIZE) ? PUT_RECORD_SIZE : size;
+      if(recordSize > (0x00010000UL - (address & 0xFFFF)))
+      {
+         recordSize = (0x00010000UL - (address & 0xFFFF));
       }
-      else if((ihex->buffer[MIN_RECORD_SIZE - 0x01] == '\n') ||
-              (ihex->buffer[MAX_RECORD_SIZE] == '\n'))
+
+      if(putRecord(ihex, 0x00, (unsigned int)(address & 0xFFFF), data,
+                   (unsigned char)recordSize))
       {
-         ihex->error = 0x04;
          return true;
       }
 
-      /*Verify fields*/
-      ihex->error = 0x05;
-      if(ihex->buffer[0x00] != ':')
+      address += recordSize;
+      data += recordSize;
+      size -= recordSize;
+   }
+
+   return false;
+}
+
+
+/* Write Intel HEX End-of-File record.
+ *
+ * INPUT : ihex - IHex_Session handle
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool IHex_PutEnd(struct IHex_Session *restrict ihex)
+{
+   if((putRecord(ihex, 0x01, 0x00, NULL, 0x00)) ||
+      (fflush(ihex->file)))
+   {
+      ihex->error = 0x08;
+      return true;
+   }
+
+   return false;
+}
+
+
+/* Close an Intel HEX file.
+ *
+ * INPUT : ihex - An IHex_Session handle
+ *
+ * OUTPUT: None
+ */
+void IHex_Close(struct IHex_Session *restrict ihex)
+{
+   if(ihex->file != NULL)
+   {
+      fclose(ihex->file);
+   }
+
+   if(ihex->map != NULL)
+   {
+      Platform_UnmapFile(ihex->map, ihex->mapSize);
+   }
+
+   free(ihex->segments);
+   free(ihex->data);
+
+   ihex->file = NULL;
+   ihex->map = NULL;
+   ihex->segments = NULL;
+   ihex->data = NULL;
+   ihex->count = 0x00;
+}
+
+
+/* Retrieve last IHex_Session error code.
+ *
+ * INPUT : ihex - An IHex_Session handle
+ *
+ * OUTPUT: [Return] - error code
+ */
+unsigned int IHex_GetError(struct IHex_Session *restrict ihex)
+{
+   return ihex->error;
+}
+
+
+/* Retrieve last IHex_Session error code string.
+ *
+ * INPUT : ihex - An IHex_Session handle
+ *
+ * OUTPUT: [Return] - error code string
+ */
+const char *IHex_GetErrorString(struct IHex_Session *restrict ihex)
+{
+   const char *lookup[] =
+   {
+      "Failed to open Intel HEX file",
+      "Failed to reset Intel HEX file",
+      "Start address not found",
+      "Record read error",
+      "Invalid record size",
+      "Invalid record field",
+      "Bad record checksum",
+      "Failed to create Intel HEX file",
+      "Record write error",
+      "Out of memory"
+   };
+
+   return lookup[ihex->error];
+}
+
+
+/* Decode all records of mapped Intel HEX file. Large files are split at
+ * line boundaries into chunks decoded in parallel (each chunk decodes data
+ * records directly into its own region of the data buffer), then chunk
+ * results are merged in file order (applying extended address state) and
+ * mapped to address ordered segments.
+ *
+ * INPUT : ihex - IHex_Session handle
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool parseFile(struct IHex_Session *restrict ihex)
+{
+   struct parseChunk *chunks;
+   struct parseChunk *chunk;
+   struct dataRun *runs = NULL;
+   const char *map = ihex->map;
+   const char *end = map + ihex->mapSize;
+   const char *pos = map;
+   unsigned long addressOffset = 0x00;
+   unsigned int chunkCount;
+   unsigned int runCount = 0x00;
+   unsigned int i;
+   unsigned int j;
+   bool done = false;
+   bool ret = true;
+
+   chunkCount = (unsigned int)(ihex->mapSize / PARSE_CHUNK_MIN);
+   if(chunkCount > Platform_GetProcessorCount())
+   {
+      chunkCount = Platform_GetProcessorCount();
+   }
+   if(chunkCount > PARSE_CHUNK_MAX)
+   {
+      chunkCount = PARSE_CHUNK_MAX;
+   }
+   else if(!chunkCount)
+   {
+      chunkCount = 0x01;
+   }
+
+   /*Decoded data (and trailing checksum) is never more than half the size of
+     the file*/
+   ihex->data = malloc((ihex->mapSize / 0x02) + 0x01);
+   chunks = calloc(chunkCount, sizeof(struct parseChunk));
+   if((ihex->data == NULL) ||
+      (chunks == NULL))
+   {
+      free(chunks);
+      ihex->error = 0x09;
+      return true;
+   }
+
+   /*Split file into chunks (at line boundaries)*/
+   for(i = 0x00; i < chunkCount; i++)
+   {
+      chunk = &chunks[i];
+      chunk->start = pos;
+      chunk->end = map + ((ihex->mapSize / chunkCount) * (i + 0x01));
+      chunk->fileEnd = end;
+      if(i == (chunkCount - 0x01))
       {
-         return true;
+         chunk->end = end;
       }
-      else if(convertHex((char *)ihex->buffer + 0x01, &dataSize, 0x01))
+      else
       {
-         return true;
+         chunk->end = (chunk->end < pos) ? pos : chunk->end;
+         while((chunk->end < end) &&
+               (*chunk->end++ != '\n'));
       }
-      else if(convertHex((char *)ihex->buffer + 0x03, &dataAddress, 0x02))
+      chunk->data = ihex->data + ((chunk->start - map) / 0x02);
+      pos = chunk->end;
+   }
+
+   /*Decode chunks (first chunk on calling thread)*/
+   for(i = 0x01; i < chunkCount; i++)
+   {
+      chunks[i].threadCreated = !Platform_CreateThread(&chunks[i].thread,
+                                                       parseWorker,
+                                                       &chunks[i]);
+   }
+
+   parseChunk(&chunks[0x00]);
+   for(i = 0x01; i < chunkCount; i++)
+   {
+      if(chunks[i].threadCreated)
       {
-         return true;
+         Platform_JoinThread(chunks[i].thread);
       }
-      else if(convertHex((char *)ihex->buffer + 0x07, &recordType, 0x01))
+      else
       {
-         return true;
+         parseChunk(&chunks[i]);
       }
+   }
 
-      dataAddress = NTOH16(dataAddress);
+   /*Merge chunk results in file order*/
+   for(i = 0x00; i < chunkCount; i++)
+   {
+      runCount += chunks[i].runCount;
+   }
 
-      /*Check checksum*/
-      check = (unsigned long)dataSize + ((dataAddress & 0xFF00) >> 0x08) +
-               (dataAddress & 0x00FF) + recordType;
-      if(dataSize > 0x00)
+   runs = malloc((runCount + 0x01) * sizeof(struct dataRun));
+   if(runs == NULL)
+   {
+      ihex->error = 0x09;
+      goto freeChunks;
+   }
+
+   runCount = 0x00;
+   for(i = 0x00; i < chunkCount; i++)
+   {
+      chunk = &chunks[i];
+      if(chunk->runs == NULL)
+      {
+         ihex->error = 0x09;
+         goto freeChunks;
+      }
+
+      /*Runs before first extended address record use incoming offset*/
+      for(j = 0x00; j < chunk->runCount; j++)
       {
-         dataSize--;
-         for(i = 0x00; i <= dataSize; i++)
+         runs[runCount] = chunk->runs[j];
+         if(j < chunk->relativeCount)
          {
-            if(convertHex((char *)ihex->buffer + 0x09 + (i * 0x02), &check1,
-                          0x01))
-            {
-               return true;
-            }
-            check += check1;
+            runs[runCount].address += addressOffset;
          }
-         dataSize++;
+         runs[runCount].order = runCount;
+         runCount++;
       }
 
-      check = ((~check) + 0x01);
-      if((convertHex((char *)ihex->buffer + 0x09 + (dataSize * 0x02), &check1,
-                     0x01)) ||
-         ((check & 0xFF) != check1))
+      if(chunk->addressOffsetSet)
       {
-         ihex->error = 0x06;
-         return true;
+         addressOffset = chunk->addressOffset;
+      }
+
+      if(chunk->startAddressSet)
+      {
+         ihex->startAddress = chunk->startAddress;
+         ihex->startAddressSet = true;
+      }
+
+      if(chunk->eof)
+      {
+         done = true;
+         break;
+      }
+      else if(chunk->failed)
+      {
+         ihex->error = chunk->error;
+         goto freeChunks;
+      }
+   }
+
+   if(!done)
+   {
+      ihex->error = 0x03;
+      goto freeChunks;
+   }
+
+   ret = buildSegments(ihex, runs, runCount);
+freeChunks:
+   for(i = 0x00; i < chunkCount; i++)
+   {
+      free(chunks[i].runs);
+   }
+   free(chunks);
+   free(runs);
+   return ret;
+}
+
+
+/* Decode chunk of Intel HEX file on worker thread.
+ *
+ * INPUT : arg - parseChunk
+ *
+ * OUTPUT: [Return] - PLATFORM_THREAD_EXIT
+ */
+PLATFORM_THREAD(parseWorker, arg)
+{
+   parseChunk(arg);
+   return PLATFORM_THREAD_EXIT;
+}
+
+
+/* Decode all records of chunk (records starting within chunk). Decoding
+ * stops at the first error or End-of-File record. Data addresses are relative
+ * to the incoming extended address until the chunk sets its own.
+ *
+ * INPUT : chunk - parseChunk
+ *
+ * OUTPUT: None
+ */
+void parseChunk(struct parseChunk *restrict chunk)
+{
+   const char *pos = chunk->start;
+   const char *end = chunk->fileEnd;
+   unsigned char header[0x04];
+   unsigned char dataSize;
+   unsigned int dataAddress;
+   unsigned char recordType;
+   unsigned char check;
+   unsigned char *data;
+   unsigned long address;
+   unsigned long used = 0x00;
+   unsigned int i;
+   struct dataRun *last;
+   unsigned int runMax = RUN_ALLOC_SIZE;
+
+   chunk->runs = malloc(runMax * sizeof(struct dataRun));
+   if(chunk->runs == NULL)
+   {
+      return;
+   }
+
+   chunk->failed = true;
+   while(0x01)
+   {
+      /*Skip line endings*/
+      while((pos < chunk->end) &&
+            ((*pos == '\r') || (*pos == '\n')))
+      {
+         pos++;
+      }
+
+      if(pos == chunk->end)
+      {
+         chunk->failed = false;
+         return;
+      }
+      else if((end - pos) < MIN_RECORD_SIZE)
+      {
+         chunk->error = 0x04;
+         return;
+      }
+
+      /*Verify fields*/
+      chunk->error = 0x05;
+      if((*pos != ':') ||
+         (convertHex(pos + 0x01, header, 0x04)))
+      {
+         return;
+      }
+
+      dataSize = header[0x00];
+      dataAddress = ((unsigned int)header[0x01] << 0x08) | header[0x02];
+      recordType = header[0x03];
+      if((unsigned long)(end - pos) <
+         (MIN_RECORD_SIZE + ((unsigned long)dataSize * 0x02)))
+      {
+         chunk->error = 0x04;
+         return;
+      }
+
+      /*Data records decode in place, others to record buffer*/
+      data = (recordType == 0x00) ? (chunk->data + used) : chunk->buffer;
+      if(convertHex(pos + 0x09, data, dataSize + 0x01))
+      {
+         return;
+      }
+      check = data[dataSize];
+
+      /*Check checksum (sum of all bytes is zero)*/
+      check += header[0x00] + header[0x01] + header[0x02] + header[0x03];
+      for(i = 0x00; i < dataSize; i++)
+      {
+         check += data[i];
+      }
+
+      if(check)
+      {
+         chunk->error = 0x06;
+         return;
+      }
+
+      /*Record must be followed by line ending*/
+      pos += MIN_RECORD_SIZE + (dataSize * 0x02);
+      if((pos < end) &&
+         (*pos != '\r') && (*pos != '\n'))
+      {
+         chunk->error = 0x04;
+         return;
       }
 
       /*Analyze data*/
       if(recordType == 0x00)
       {
-         *address = (ihex->addressOffset + dataAddress);
-         *data = ihex->buffer;
-         *size = dataSize;
+         if(!dataSize)
+         {
+            continue;
+         }
 
-         if(convertHex((char *)ihex->buffer + 0x09, ihex->buffer, dataSize))
+         address = (chunk->addressOffset + dataAddress);
+
+         /*Extend last run if record is contiguous (and both are relative
+           to the same address offset)*/
+         last = (chunk->runCount) ? &chunk->runs[chunk->runCount - 0x01] :
+                                    NULL;
+         if((last != NULL) &&
+            ((last->address + last->size) == address) &&
+            ((chunk->runCount == chunk->relativeCount) ==
+             !chunk->addressOffsetSet))
          {
-            return true;
+            last->size += dataSize;
          }
-         break;
+         else
+         {
+            if(chunk->runCount == runMax)
+            {
+               runMax *= 0x02;
+               last = realloc(chunk->runs, runMax * sizeof(struct dataRun));
+               if(last == NULL)
+               {
+                  chunk->error = 0x09;
+                  return;
+               }
+               chunk->runs = last;
+            }
+
+            last = &chunk->runs[chunk->runCount++];
+            last->address = address;
+            last->size = dataSize;
+            last->data = data;
+            if(!chunk->addressOffsetSet)
+            {
+               chunk->relativeCount = chunk->runCount;
+            }
+         }
+
+         used += dataSize;
       }
       /*End-of-File*/
       else if((recordType == 0x01) &&
               (!dataSize))
       {
-         *address = 0x00;
-         *data = NULL;
-         *size = 0x00;
-         break;
+         chunk->failed = false;
+         chunk->eof = true;
+         return;
       }
-      /*16-bit Address Offset*/
+      /*Extended Segment Address (segment base * 16)*/
       else if((recordType == 0x02) &&
               (dataSize == 0x02))
       {
-         if(convertHex((char *)ihex->buffer + 0x09, &ihex->addressOffset,
-                       0x02))
-         {
-            return true;
-         }
-         ihex->addressOffset = NTOH16(ihex->addressOffset);
+         chunk->addressOffset = ((((unsigned long)data[0x00] << 0x08) |
+                                  data[0x01]) << 0x04);
+         chunk->addressOffsetSet = true;
       }
-      /*32-bit (x86 RM CS:IP) Start Address*/
-      else if((recordType == 0x03) &&
+      /*32-bit (x86 RM CS:IP) Start Address or 32-bit Start Address*/
+      else if(((recordType == 0x03) || (recordType == 0x05)) &&
               (dataSize == 0x04))
       {
-         if(convertHex((char *)ihex->buffer + 0x09, &ihex->startAddress, 0x04))
-         {
-            return false;
-         }
-         ihex->startAddress = NTOH32(ihex->startAddress);
-         ihex->startAddressSet = true;
+         chunk->startAddress = (((unsigned long)data[0x00] << 0x18) |
+                                ((unsigned long)data[0x01] << 0x10) |
+                                ((unsigned long)data[0x02] << 0x08) |
+                                data[0x03]);
+         chunk->startAddressSet = true;
       }
-      /*32-bit Address Offset*/
+      /*Extended Linear Address (upper 16-bits of 32-bit address)*/
       else if((recordType == 0x04) &&
-              (dataSize == 0x04))
+              (dataSize == 0x02))
       {
-         if(convertHex((char *)ihex->buffer + 0x09, &ihex->addressOffset,
-                       0x04))
-         {
-            return true;
-         }
-         ihex->addressOffset = NTOH32(ihex->addressOffset);
-      }
-      /*32-bit Start Address*/
-      else if((recordType == 0x05) &&
-              (dataSize == 0x04))
-      {
-         if(convertHex((char *)ihex->buffer + 0x09, &ihex->startAddress, 0x04))
-         {
-            return true;
-         }
-         ihex->startAddress = NTOH32(ihex->startAddress);
-         ihex->startAddressSet = true;
+         chunk->addressOffset = ((((unsigned long)data[0x00] << 0x08) |
+                                  data[0x01]) << 0x10);
+         chunk->addressOffsetSet = true;
       }
       else
       {
-         return true;
+         return;
       }
    }
-
-   return false;
 }
 
 
-/* Close an Intel HEX file.
+/* Map data runs (in file order) to address ordered segments, merging
+ * adjacent and overlapping runs. Data is only copied (into a new buffer) if
+ * merged runs are not already contiguous in the data buffer.
  *
- * INPUT : ihex - An IHex_Session handle
+ * INPUT : ihex - IHex_Session handle
+ *         runs - data runs
+ *         count - number of data runs
  *
- * OUTPUT: None
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
  */
-void IHex_Close(struct IHex_Session *restrict ihex)
+bool buildSegments(struct IHex_Session *restrict ihex,
+                   struct dataRun *restrict runs, unsigned int count)
 {
-   fclose(ihex->file);
-}
+   struct IHex_Segment *segment;
+   struct dataRun *ordered;
+   unsigned char *data;
+   unsigned long segmentEnd;
+   unsigned int i;
+   bool copy = false;
 
+   if(!count)
+   {
+      return false;
+   }
 
-/* Retrieve last IHex_Session error code.
- *
- * INPUT : ihex - An IHex_Session handle
- *
- * OUTPUT: [Return] - error code
- */
-unsigned int IHex_GetError(struct IHex_Session *restrict ihex)
-{
-   return ihex->error;
+   ihex->segments = malloc(count * sizeof(struct IHex_Segment));
+   if(ihex->segments == NULL)
+   {
+      ihex->error = 0x09;
+      return true;
+   }
+
+   /*Order runs by address (then file order)*/
+   qsort(runs, count, sizeof(struct dataRun), compareRuns);
+
+   for(i = 0x00; i < count; i++)
+   {
+      segment = (ihex->count) ? &ihex->segments[ihex->count - 0x01] : NULL;
+      segmentEnd = (segment != NULL) ? (segment->address + segment->size) :
+                                       0x00;
+
+      if((segment != NULL) &&
+         (runs[i].address <= segmentEnd))
+      {
+         /*Overlapping or non-contiguous data must be copied*/
+         if((runs[i].address < segmentEnd) ||
+            ((segment->data + segment->size) != runs[i].data))
+         {
+            copy = true;
+         }
+
+         if((runs[i].address + runs[i].size) > segmentEnd)
+         {
+            ihex->size += (runs[i].address + runs[i].size) - segmentEnd;
+            segment->size = (runs[i].address + runs[i].size) -
+                            segment->address;
+         }
+      }
+      else
+      {
+         segment = &ihex->segments[ihex->count++];
+         segment->address = runs[i].address;
+         segment->size = runs[i].size;
+         segment->data = runs[i].data;
+         ihex->size += runs[i].size;
+      }
+
+      runs[i].segment = ihex->count - 0x01;
+   }
+
+   if(!copy)
+   {
+      return false;
+   }
+
+   /*Lay out segments in new buffer and copy runs in file order (so later
+     records overwrite earlier ones)*/
+   data = malloc(ihex->size);
+   ordered = malloc(count * sizeof(struct dataRun));
+   if((data == NULL) ||
+      (ordered == NULL))
+   {
+      free(data);
+      free(ordered);
+      ihex->error = 0x09;
+      return true;
+   }
+
+   segmentEnd = 0x00;
+   for(i = 0x00; i < ihex->count; i++)
+   {
+      ihex->segments[i].data = data + segmentEnd;
+      segmentEnd += ihex->segments[i].size;
+   }
+
+   for(i = 0x00; i < count; i++)
+   {
+      segment = &ihex->segments[runs[i].segment];
+      ordered[runs[i].order] = runs[i];
+      ordered[runs[i].order].address = (segment->data - data) +
+                                       (runs[i].address - segment->address);
+   }
+
+   for(i = 0x00; i < count; i++)
+   {
+      memcpy(data + ordered[i].address, ordered[i].data, ordered[i].size);
+   }
+
+   free(ordered);
+   free(ihex->data);
+   ihex->data = data;
+   return false;
 }
 
 
-/* Retrieve last IHex_Session error code string.
+/* Compare data runs by address then file order (for qsort).
  *
- * INPUT : ihex - An IHex_Session handle
+ * INPUT : a - data run
+ *         b - data run
  *
- * OUTPUT: [Return] - error code string
+ * OUTPUT: [Return] - <0, 0, >0 if a is ordered before, equal to or after b
  */
-const char *IHex_GetErrorString(struct IHex_Session *restrict ihex)
+int compareRuns(const void *a, const void *b)
 {
-   const char *lookup[] =
+   const struct dataRun *runA = a;
+   const struct dataRun *runB = b;
+
+   if(runA->address != runB->address)
    {
-      "Failed to open Intel HEX file",
-      "Failed to reset Intel HEX file",
-      "Start address not found",
-      "Record read error",
-      "Invalid record size",
-      "Invalid record field",
-      "Bad record checksum"
-   };
+      return (runA->address < runB->address) ? -0x01 : 0x01;
+   }
 
-   return lookup[ihex->error];
+   return (runA->order > runB->order) - (runA->order < runB->order);
 }
 
 
-/* Convert hexadecimal string of characters to actual binary.
+/* Convert hexadecimal string of characters to actual binary. Characters are
+ * converted via lookup table (all characters are validated, any invalid
+ * character results in an error) and long strings are converted 16 bytes at
+ * a time where SSE2 is available.
  *
  * INPUT : src - hexadecimal character string
  *         size - size of hexadecimal character string divided by 2
@@ -352,74 +922,120 @@ const char *IHex_GetErrorString(struct IHex_Session *restrict ihex)
  * OUTPUT: dest - binary representation output
  *         [Return] - true if an error occurred, false otherwise
  */
-bool convertHex(const char *src, void *dest, unsigned char size)
+bool convertHex(const char *src, void *dest, unsigned int size)
 {
-   unsigned char i;
+   const unsigned char *str = (const unsigned char *)src;
    unsigned char *buf = dest;
-   bool high = true;
-   const char *hexMap = "0123456789ABCDEF";
+   unsigned char high;
+   unsigned char low;
+   unsigned char invalid = 0x00;
 
-   for(; size > 0x00; src++)
+#if defined(__SSE2__)
+   for(; size >= CONVERT_BLOCK_SIZE; size -= CONVERT_BLOCK_SIZE)
    {
-      for(i = 0x00; i <= strlen(hexMap); i++)
+      if(convertHexBlock(str, buf))
       {
-         if(hexMap[i] == '\0')
-         {
-            return true;
-         }
-         else if(toupper(*src) == hexMap[i])
-         {
-            if(high)
-            {
-               *buf = (i << 0x04);
-            }
-            else
-            {
-               *buf |= i;
-               size--;
-               buf++;
-            }
-            high ^= true;
-            break;
-         }
+         return true;
       }
+      str += (CONVERT_BLOCK_SIZE * 0x02);
+      buf += CONVERT_BLOCK_SIZE;
    }
+#endif
 
-   return false;
+   for(; size > 0x00; size--)
+   {
+      high = hexTable[*str++];
+      low = hexTable[*str++];
+      invalid |= (high | low);
+      *buf++ = (unsigned char)((high << 0x04) | (low & 0x0F));
+   }
+
+   return (invalid & HEX_INVALID);
 }
 
 
-/* Swap incoming big-endian value to host endianess.
+#if defined(__SSE2__)
+/* Convert block of hexadecimal characters (digits and upper or lower case
+ * letters) to binary using SSE2.
  *
- * INPUT : u16 - value to (possibly) swap endianess from
- * 
- * OUTPUT: [Return] - value with endianess (possibly) swapped
+ * INPUT : src - hexadecimal character string (CONVERT_BLOCK_SIZE * 2 long)
+ *
+ * OUTPUT: dest - binary representation output (CONVERT_BLOCK_SIZE long)
+ *         [Return] - true if an error occurred, false otherwise
  */
-unsigned int swap16(const unsigned int u16)
+bool convertHexBlock(const unsigned char *src, unsigned char *dest)
 {
-   union size16 result;
-   
-   result.u8[0x00] = (unsigned char)((u16 & 0xFF00) >> 0x08);
-   result.u8[0x01] = (unsigned char)(u16 & 0x00FF);
+   __m128i chars[0x02];
+   __m128i digit;
+   __m128i alpha;
+   __m128i isDigit;
+   __m128i isAlpha;
+   int valid = 0xFFFF;
+   unsigned char i;
 
-   return (result.u16 & 0xFFFF);
+   chars[0x00] = _mm_loadu_si128((const __m128i *)src);
+   chars[0x01] = _mm_loadu_si128((const __m128i *)(src + 0x10));
+
+   for(i = 0x00; i < 0x02; i++)
+   {
+      /*Classify as '0'-'9' or 'A'-'F'/'a'-'f' and take nibble value*/
+      digit = _mm_sub_epi8(chars[i], _mm_set1_epi8('0'));
+      alpha = _mm_sub_epi8(_mm_or_si128(chars[i], _mm_set1_epi8(0x20)),
+                           _mm_set1_epi8('a' - 0x0A));
+      isDigit = _mm_and_si128(_mm_cmpgt_epi8(digit, _mm_set1_epi8(-0x01)),
+                              _mm_cmplt_epi8(digit, _mm_set1_epi8(0x0A)));
+      isAlpha = _mm_and_si128(_mm_cmpgt_epi8(alpha, _mm_set1_epi8(0x09)),
+                              _mm_cmplt_epi8(alpha, _mm_set1_epi8(0x10)));
+      valid &= _mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha));
+
+      /*Combine nibble pairs (high nibble is first character)*/
+      chars[i] = _mm_or_si128(_mm_and_si128(isDigit, digit),
+                              _mm_and_si128(isAlpha, alpha));
+      chars[i] = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(chars[i],
+                                                 _mm_set1_epi16(0x00FF)),
+                                             0x04),
+                              _mm_srli_epi16(chars[i], 0x08));
+   }
+
+   _mm_storeu_si128((__m128i *)dest, _mm_packus_epi16(chars[0x00],
+                                                      chars[0x01]));
+   return (valid != 0xFFFF);
 }
+#endif
 
 
-/* Swap incoming big-endian value to host endianess.
+/* Write single Intel HEX record.
  *
- * INPUT : u32 - value to (possibly) swap endianess from
- * 
- * OUTPUT: [Return] - value with endianess (possibly) swapped
+ * INPUT : ihex - IHex_Session handle
+ *         type - record type
+ *         address - record (16-bit) address
+ *         data - record data
+ *         size - size of record data
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
  */
-unsigned long swap32(const unsigned long u32)
+bool putRecord(struct IHex_Session *restrict ihex, unsigned char type,
+               unsigned int address, const unsigned char *restrict data,
+               unsigned char size)
 {
-   union size32 result;
-   
-   result.u8[0x00] = (unsigned char)((u32 & 0xFF000000UL) >> 0x18);
-   result.u8[0x01] = (unsigned char)((u32 & 0x00FF0000UL) >> 0x10);
-   result.u8[0x02] = (unsigned char)((u32 & 0x0000FF00UL) >> 0x08);
-   result.u8[0x03] = (unsigned char)(u32 & 0x000000FFUL);
-
-   return (result.u32 & 0xFFFFFFFFUL);
+   unsigned char i;
+   char *record = (char *)ihex->buffer;
+   unsigned char check = size + ((address & 0xFF00) >> 0x08) +
+                         (address & 0x00FF) + type;
+
+   record += sprintf(record, ":%02X%04X%02X", size, address, type);
+   for(i = 0x00; i < size; i++)
+   {
+      record += sprintf(record, "%02X", data[i]);
+      check += data[i];
+   }
+   sprintf(record, "%02X\n", (unsigned char)((~check) + 0x01));
+
+   if(fputs((char *)ihex->buffer, ihex->file) == EOF)
+   {
+      ihex->error = 0x08;
+      return true;
+   }
+
+   return false;
 }
@@ -8,12 +8,27 @@
 #define IHEX_H
 #include <stdbool.h>
 #include <stdio.h>
+#include <stddef.h>
 
 #define MAX_RECORD_SIZE (0x0208 + sizeof('\n'))
 
+struct IHex_Segment
+{
+   unsigned long address;
+   unsigned long size;
+   const unsigned char *data;
+};
+
 struct IHex_Session
 {
    FILE *file;
+   void *map;
+   size_t mapSize;
+   unsigned char *data;
+   struct IHex_Segment *segments;
+   unsigned int count;
+   unsigned int next;
+   unsigned long size;
    bool startAddressSet;
    unsigned long startAddress;
    unsigned long addressOffset;
@@ -23,13 +38,18 @@ struct IHex_Session
 
 
 bool IHex_Open(struct IHex_Session *restrict, const char *restrict);
+bool IHex_Create(struct IHex_Session *restrict, const char *restrict);
 void IHex_Close(struct IHex_Session *restrict);
 bool IHex_Reset(struct IHex_Session *restrict);
 bool IHex_GetTotalSize(struct IHex_Session *restrict, unsigned long *restrict);
 bool IHex_GetStartAddress(struct IHex_Session *restrict,
                           unsigned long *restrict);
 bool IHex_GetNextData(struct IHex_Session *restrict, unsigned long *restrict,
-                      unsigned char **restrict, unsigned char *restrict);
+                      const unsigned char **restrict,
+                      unsigned long *restrict);
+bool IHex_PutData(struct IHex_Session *restrict, unsigned long,
+                  const unsigned char *restrict, unsigned long);
+bool IHex_PutEnd(struct IHex_Session *restrict);
 unsigned int IHex_GetError(struct IHex_Session *restrict);
 const char *IHex_GetErrorString(struct IHex_Session *restrict);
 
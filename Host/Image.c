@@ -0,0 +1,425 @@
+/******************************************************************************/
+/*Filename:    Image.c                                                        */
+/*Project:     CNC 1                                                          */
+/*Author:      New Rupture Systems                                            */
+/*Description: Function definitions for sparse memory image loading.         */
+/******************************************************************************/
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Platform.h"
+#include "IHex.h"
+#include "Image.h"
+
+/*ELF (32-bit, little-endian) format constants*/
+#define ELF_HEADER_SIZE  (0x34)
+#define ELF_PHEADER_SIZE (0x20)
+#define ELF_CLASS_32     (0x01)
+#define ELF_DATA_LSB     (0x01)
+#define ELF_PT_LOAD      (0x01)
+
+/*AVR toolchains place non-flash memories (SRAM, EEPROM, fuses, etc.) at
+  physical addresses 0x800000 and above, only flash and EEPROM are loaded*/
+#define ELF_FLASH_END    (0x00800000UL)
+#define ELF_EEPROM_START (0x00810000UL)
+#define ELF_EEPROM_END   (0x00820000UL)
+
+static bool loadIHex(struct Image_Session *restrict, const char *restrict);
+static bool loadELF(struct Image_Session *restrict);
+static bool loadBinary(struct Image_Session *restrict, unsigned long long);
+static bool addSegment(struct Image_Session *restrict, unsigned long long,
+                       const unsigned char *, unsigned long);
+static int compareSegments(const void *, const void *);
+static unsigned long getLE32(const unsigned char *);
+static unsigned int getLE16(const unsigned char *);
+
+
+/* Open a memory image file. ELF files are detected by content, files ending
+ * in ".bin" are loaded as raw binary (at offset) and all other files are
+ * loaded as Intel HEX.
+ *
+ * INPUT : img - Image_Session handle
+ *         filename - name of file to open
+ *         offset - load address of raw binary file
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool Image_Open(struct Image_Session *restrict img,
+                const char *restrict filename, unsigned long long offset)
+{
+   const char *ext = strrchr(filename, '.');
+   bool ret;
+
+   img->segments = NULL;
+   img->count = 0x00;
+   img->size = 0x00;
+   img->ihexOpen = false;
+   img->map = NULL;
+   img->mapSize = 0x00;
+
+   if(Platform_MapFile(filename, &img->map, &img->mapSize))
+   {
+      img->map = NULL;
+      img->error = 0x00;
+      return true;
+   }
+
+   if((img->mapSize >= 0x04) &&
+      (memcmp(img->map, "\x7F" "ELF", 0x04) == 0x00))
+   {
+      ret = loadELF(img);
+   }
+   else if((ext != NULL) &&
+           ((strcmp(ext, ".bin") == 0x00) ||
+            (strcmp(ext, ".BIN") == 0x00)))
+   {
+      ret = loadBinary(img, offset);
+   }
+   else
+   {
+      /*Intel HEX is mapped and decoded by IHex session*/
+      Platform_UnmapFile(img->map, img->mapSize);
+      img->map = NULL;
+      ret = loadIHex(img, filename);
+   }
+
+   if(ret)
+   {
+      Image_Close(img);
+      return true;
+   }
+
+   /*Order segments by address*/
+   qsort(img->segments, img->count, sizeof(struct Image_Segment),
+         compareSegments);
+   return false;
+}
+
+
+/* Close a memory image file.
+ *
+ * INPUT : img - Image_Session handle
+ *
+ * OUTPUT: [None]
+ */
+void Image_Close(struct Image_Session *restrict img)
+{
+   free(img->segments);
+   if(img->ihexOpen)
+   {
+      IHex_Close(&img->ihex);
+   }
+   if(img->map != NULL)
+   {
+      Platform_UnmapFile(img->map, img->mapSize);
+   }
+
+   img->segments = NULL;
+   img->ihexOpen = false;
+   img->map = NULL;
+}
+
+
+/* Get total size of all image segments.
+ *
+ * INPUT : img - Image_Session handle
+ *
+ * OUTPUT: [Return] - total size of image data
+ */
+unsigned long Image_GetTotalSize(struct Image_Session *restrict img)
+{
+   return img->size;
+}
+
+
+/* Get number of image segments.
+ *
+ * INPUT : img - Image_Session handle
+ *
+ * OUTPUT: [Return] - number of segments
+ */
+unsigned int Image_GetSegmentCount(struct Image_Session *restrict img)
+{
+   return img->count;
+}
+
+
+/* Get image segment (segments are ordered by address).
+ *
+ * INPUT : img - Image_Session handle
+ *         index - index of segment
+ *
+ * OUTPUT: address - location to store segment address
+ *         data - location to store location of segment data
+ *         size - location to store segment size
+ *         [Return] - true if an error occurred, false otherwise
+ */
+bool Image_GetSegment(struct Image_Session *restrict img, unsigned int index,
+                      unsigned long long *restrict address,
+                      const unsigned char **restrict data,
+                      unsigned long *restrict size)
+{
+   if(index >= img->count)
+   {
+      img->error = 0x04;
+      return true;
+   }
+
+   *address = img->segments[index].address;
+   *data = img->segments[index].data;
+   *size = img->segments[index].size;
+   return false;
+}
+
+
+/* Retrieve last Image_Session error code.
+ *
+ * INPUT : img - Image_Session handle
+ *
+ * OUTPUT: [Return] - error code
+ */
+unsigned int Image_GetError(struct Image_Session *restrict img)
+{
+   return img->error;
+}
+
+
+/* Retrieve last Image_Session error code string.
+ *
+ * INPUT : img - Image_Session handle
+ *
+ * OUTPUT: [Return] - error code string
+ */
+const char *Image_GetErrorString(struct Image_Session *restrict img)
+{
+   const char *lookup[] =
+   {
+      "Failed to open image file",
+      "Invalid or unsupported ELF file",
+      "Invalid Intel HEX file",
+      "Out of memory",
+      "Invalid segment index"
+   };
+
+   return lookup[img->error];
+}
+
+
+/* Load Intel HEX file data segments as image segments. Data is referenced
+ * directly from the (open) IHex session.
+ *
+ * INPUT : img - Image_Session handle
+ *         filename - name of Intel HEX file
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool loadIHex(struct Image_Session *restrict img,
+              const char *restrict filename)
+{
+   unsigned long address;
+   const unsigned char *data;
+   unsigned long size;
+
+   if(IHex_Open(&img->ihex, filename))
+   {
+      img->error = (IHex_GetError(&img->ihex) == 0x00) ? 0x00 : 0x02;
+      return true;
+   }
+   img->ihexOpen = true;
+
+   while(0x01)
+   {
+      if(IHex_GetNextData(&img->ihex, &address, &data, &size))
+      {
+         img->error = 0x02;
+         return true;
+      }
+
+      if(data == NULL)
+      {
+         break;
+      }
+      else if(addSegment(img, address, data, size))
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+
+/* Load ELF file loadable (PT_LOAD) program segments as image segments (EEPROM
+ * segments are moved to IMAGE_EEPROM_ADDRESS). Data is referenced directly
+ * from the mapped file.
+ *
+ * INPUT : img - Image_Session handle
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool loadELF(struct Image_Session *restrict img)
+{
+   unsigned long phOffset;
+   unsigned int phSize;
+   unsigned int phCount;
+   unsigned int i;
+   const unsigned char *ph;
+   unsigned long offset;
+   unsigned long long address;
+   unsigned long size;
+   const unsigned char *elf = img->map;
+
+   /*Validate header*/
+   img->error = 0x01;
+   if((img->mapSize < ELF_HEADER_SIZE) ||
+      (elf[0x04] != ELF_CLASS_32) ||
+      (elf[0x05] != ELF_DATA_LSB))
+   {
+      return true;
+   }
+
+   phOffset = getLE32(elf + 0x1C);
+   phSize = getLE16(elf + 0x2A);
+   phCount = getLE16(elf + 0x2C);
+   if((phSize < ELF_PHEADER_SIZE) ||
+      (phOffset > img->mapSize) ||
+      (((img->mapSize - phOffset) / phSize) < phCount))
+   {
+      return true;
+   }
+
+   /*Add each loadable (flash and EEPROM) segment*/
+   for(i = 0x00; i < phCount; i++)
+   {
+      ph = elf + phOffset + (i * phSize);
+      offset = getLE32(ph + 0x04);
+      address = getLE32(ph + 0x0C);
+      size = getLE32(ph + 0x10);
+
+      if((getLE32(ph) != ELF_PT_LOAD) ||
+         (size == 0x00))
+      {
+         continue;
+      }
+
+      if((address >= ELF_EEPROM_START) &&
+         (address < ELF_EEPROM_END))
+      {
+         address = (IMAGE_EEPROM_ADDRESS + (address - ELF_EEPROM_START));
+      }
+      else if(address >= ELF_FLASH_END)
+      {
+         continue;
+      }
+
+      if((offset > img->mapSize) ||
+         (size > (img->mapSize - offset)))
+      {
+         img->error = 0x01;
+         return true;
+      }
+
+      if(addSegment(img, address, elf + offset, size))
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+
+/* Load raw binary file as a single image segment. Data is referenced
+ * directly from the mapped file.
+ *
+ * INPUT : img - Image_Session handle
+ *         offset - load address of file
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool loadBinary(struct Image_Session *restrict img,
+                unsigned long long offset)
+{
+   return addSegment(img, offset, img->map, img->mapSize);
+}
+
+
+/* Append segment to image.
+ *
+ * INPUT : img - Image_Session handle
+ *         address - segment address
+ *         data - segment data
+ *         size - segment size
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool addSegment(struct Image_Session *restrict img,
+                unsigned long long address, const unsigned char *data,
+                unsigned long size)
+{
+   struct Image_Segment *segments;
+
+   segments = realloc(img->segments,
+                      (img->count + 0x01) * sizeof(struct Image_Segment));
+   if(segments == NULL)
+   {
+      img->error = 0x03;
+      return true;
+   }
+
+   segments[img->count].address = address;
+   segments[img->count].data = data;
+   segments[img->count].size = size;
+   img->segments = segments;
+   img->count++;
+   img->size += size;
+   return false;
+}
+
+
+/* Compare segments by address (for qsort).
+ *
+ * INPUT : a - segment
+ *         b - segment
+ *
+ * OUTPUT: [Return] - <0, 0, >0 if a is below, equal to or above b
+ */
+int compareSegments(const void *a, const void *b)
+{
+   const struct Image_Segment *segA = a;
+   const struct Image_Segment *segB = b;
+
+   if(segA->address < segB->address)
+   {
+      return -0x01;
+   }
+
+   return (segA->address > segB->address);
+}
+
+
+/* Get little-endian 32-bit value.
+ *
+ * INPUT : src - location of value
+ *
+ * OUTPUT: [Return] - value
+ */
+unsigned long getLE32(const unsigned char *src)
+{
+   return ((unsigned long)src[0x00] |
+           ((unsigned long)src[0x01] << 0x08) |
+           ((unsigned long)src[0x02] << 0x10) |
+           ((unsigned long)src[0x03] << 0x18));
+}
+
+
+/* Get little-endian 16-bit value.
+ *
+ * INPUT : src - location of value
+ *
+ * OUTPUT: [Return] - value
+ */
+unsigned int getLE16(const unsigned char *src)
+{
+   return ((unsigned int)src[0x00] | ((unsigned int)src[0x01] << 0x08));
+}
@@ -0,0 +1,49 @@
+/******************************************************************************/
+/*Filename:    Image.h                                                        */
+/*Project:     CNC 1                                                          */
+/*Author:      New Rupture Systems                                            */
+/*Description: Sparse memory image loading (Intel HEX, ELF, raw binary)      */
+/*             utilities library.                                             */
+/******************************************************************************/
+#ifndef IMAGE_H
+#define IMAGE_H
+#include <stdbool.h>
+#include <stddef.h>
+#include "IHex.h"
+
+/*Image address of device EEPROM (ELF ".eeprom" is loaded here)*/
+#define IMAGE_EEPROM_ADDRESS (0x0000000100000000ULL)
+
+struct Image_Segment
+{
+   unsigned long long address;
+   unsigned long size;
+   const unsigned char *data;
+};
+
+struct Image_Session
+{
+   struct Image_Segment *segments;
+   unsigned int count;
+   unsigned long size;
+   struct IHex_Session ihex;
+   bool ihexOpen;
+   void *map;
+   size_t mapSize;
+   unsigned int error;
+};
+
+
+bool Image_Open(struct Image_Session *restrict, const char *restrict,
+                unsigned long long);
+void Image_Close(struct Image_Session *restrict);
+unsigned long Image_GetTotalSize(struct Image_Session *restrict);
+unsigned int Image_GetSegmentCount(struct Image_Session *restrict);
+bool Image_GetSegment(struct Image_Session *restrict, unsigned int,
+                      unsigned long long *restrict,
+                      const unsigned char **restrict,
+                      unsigned long *restrict);
+unsigned int Image_GetError(struct Image_Session *restrict);
+const char *Image_GetErrorString(struct Image_Session *restrict);
+
+#endif
@@ -14,9 +14,16 @@
 #include "Platform.h"
 #include "BCP.h"
 #include "Flash.h"
+#include "Dump.h"
+#include "Screenshot.h"
+
+/*Default dump range (ATmega324 flash)*/
+#define DUMP_DEFAULT_ADDRESS (0x00ULL)
+#define DUMP_DEFAULT_SIZE    (0x8000UL)
 
 static void outputUsage(void);
 static void flashProgress(void);
+static bool parseNumber(const char *, unsigned long long *);
 static void shutdownHook(int);
 static bool rwDevice(unsigned char *, unsigned char, bool);
 static bool hostRead(void *, unsigned char);
@@ -35,8 +42,16 @@ int main(int argc, char *argv[])
    struct libusb_device_descriptor deviceInfo;
    struct BCP_Session bcp;
    struct Flash_Session flash;
+   struct Dump_Session dump;
+   struct Screenshot_Session shot;
    unsigned char pages;
+   unsigned char skipped;
    unsigned int bytes;
+   unsigned long long address;
+   unsigned long long size;
+   unsigned long long value;
+   unsigned char pattern;
+   unsigned long long elapsed;
    int err;
    int ret = EXIT_FAILURE;
 
@@ -107,14 +122,17 @@ int main(int argc, char *argv[])
    /*Attempt to execute option specified*/
    if(strcmp(argv[0x01], "flash") == 0x00)
    {
-      if(argc != 0x03)
+      address = 0x00;
+      if(((argc != 0x03) && (argc != 0x04)) ||
+         ((argc == 0x04) &&
+          (parseNumber(argv[0x03], &address))))
       {
-         printf("Error: option 'flash' expected <filename>\n");
+         printf("Error: option 'flash' expected <filename> [<offset>]\n");
          goto bcpClose;
       }
 
       printf("--Flashing Device--\n");
-      if(Flash_Open(&flash, &bcp, argv[0x02]))
+      if(Flash_Open(&flash, &bcp, argv[0x02], address))
       {
          printf("Error: %s\n", Flash_GetErrorString(&flash));
          goto bcpClose;
@@ -129,18 +147,112 @@ int main(int argc, char *argv[])
       }
       else
       {
-         if(Flash_GetSize(&flash, &pages, &bytes))
+         if(Flash_GetSize(&flash, &pages, &skipped, &bytes))
          {
             printf("]\nDevice sucessfully flashed (#, #)\n");
          }
          else
          {
-            printf("]\nDevice successfully flashed (%u pages, %u bytes)\n",
-                   (unsigned int)pages, bytes);
+            printf("]\nDevice successfully flashed (%u pages, %u unchanged,"
+                   " %u bytes)\n", (unsigned int)pages, (unsigned int)skipped,
+                   bytes);
          }
          Flash_Close(&flash);
       }
    }
+   else if(strcmp(argv[0x01], "dump") == 0x00)
+   {
+      address = DUMP_DEFAULT_ADDRESS;
+      size = DUMP_DEFAULT_SIZE;
+      if(((argc != 0x03) && (argc != 0x05)) ||
+         ((argc == 0x05) &&
+          ((parseNumber(argv[0x03], &address)) ||
+           (parseNumber(argv[0x04], &size)) ||
+           (size > 0xFFFFFFFFULL))))
+      {
+         printf("Error: option 'dump' expected <filename> " \
+                "[<address> <size>]\n");
+         goto bcpClose;
+      }
+
+      printf("--Dumping Device--\n");
+      if(Dump_Open(&dump, &bcp, argv[0x02], address, (unsigned long)size))
+      {
+         printf("Error: %s\n", Dump_GetErrorString(&dump));
+         goto bcpClose;
+      }
+
+      elapsed = Platform_GetTimeMS();
+      if((printf("Reading:\n["), Dump_Read(&dump, flashProgress, 0x02)))
+      {
+         printf("]\nError: %s\n", Dump_GetErrorString(&dump));
+         Dump_Close(&dump);
+         goto bcpClose;
+      }
+      elapsed = (Platform_GetTimeMS() - elapsed);
+
+      printf("]\nDevice successfully dumped (%llu bytes, %llu.%03llu s, " \
+             "%llu bytes/s)\n", size, elapsed / 0x03E8, elapsed % 0x03E8,
+             (elapsed) ? ((size * 0x03E8) / elapsed) : size);
+      Dump_Close(&dump);
+   }
+   else if(strcmp(argv[0x01], "fill") == 0x00)
+   {
+      if((argc != 0x05) ||
+         (parseNumber(argv[0x02], &address)) ||
+         (parseNumber(argv[0x03], &size)) ||
+         (size > 0xFFFFFFFFULL) ||
+         (parseNumber(argv[0x04], &value)) ||
+         (value > 0xFF))
+      {
+         printf("Error: option 'fill' expected <address> <size> <byte>\n");
+         goto bcpClose;
+      }
+
+      printf("--Filling Device--\n");
+      pattern = (unsigned char)value;
+      elapsed = Platform_GetTimeMS();
+      if((BCP_SetFlags(&bcp, FLAG_ADDR_INC)) ||
+         (BCP_SetAddress(&bcp, address)) ||
+         (BCP_FillMemory(&bcp, (unsigned int)size, &pattern, 0x01)))
+      {
+         printf("Error: %s\n", BCP_GetErrorString(&bcp));
+         goto bcpClose;
+      }
+      elapsed = (Platform_GetTimeMS() - elapsed);
+
+      printf("Device successfully filled (%llu bytes, %llu.%03llu s)\n",
+             size, elapsed / 0x03E8, elapsed % 0x03E8);
+   }
+   else if(strcmp(argv[0x01], "screenshot") == 0x00)
+   {
+      if(argc != 0x03)
+      {
+         printf("Error: option 'screenshot' expected <filename>\n");
+         goto bcpClose;
+      }
+
+      printf("--Device Screenshot--\n");
+      if(Screenshot_Open(&shot, &bcp, argv[0x02]))
+      {
+         printf("Error: %s\n", Screenshot_GetErrorString(&shot));
+         goto bcpClose;
+      }
+
+      elapsed = Platform_GetTimeMS();
+      if((printf("Reading:\n["), Screenshot_Read(&shot, flashProgress, 0x02)))
+      {
+         printf("]\nError: %s\n", Screenshot_GetErrorString(&shot));
+         Screenshot_Close(&shot);
+         goto bcpClose;
+      }
+      elapsed = (Platform_GetTimeMS() - elapsed);
+
+      printf("]\nScreenshot successfully saved (%ux%u, %llu.%03llu s)\n",
+             SCREENSHOT_WIDTH, SCREENSHOT_HEIGHT, elapsed / 0x03E8,
+             elapsed % 0x03E8);
+      Screenshot_Close(&shot);
+   }
    else
    {
       printf("Error: Unknown option specified\n");
@@ -184,11 +296,46 @@ void outputUsage(void)
 {
    printf("Usage: cncControl [option] ...\n");
    printf("Options:\n");
-   printf("   flash <filename> - Write provided Intel Hex file to device\n");
+   printf("   flash <filename> [<offset>] - Write provided Intel Hex, ELF " \
+          "or raw binary\n" \
+          "      (\".bin\" loaded at <offset>, EEPROM at 0x100000000) " \
+          "file to device\n");
+   printf("   dump <filename> [<address> <size>] - Read device memory (flash " \
+          "by default)\n" \
+          "      into Intel Hex file (or raw binary if <filename> ends in " \
+          "\".bin\")\n");
+   printf("   fill <address> <size> <byte> - Fill device memory with " \
+          "<byte> (e.g. erase\n" \
+          "      EEPROM with \"fill 0x100000000 1024 0xFF\")\n");
+   printf("   screenshot <filename> - Read device display (application " \
+          "running) into\n" \
+          "      binary PPM file\n");
+}
+
+
+/* Parse (decimal, octal or hexadecimal) number from argument string.
+ *
+ * INPUT : str - argument string
+ *
+ * OUTPUT: value - parsed value
+ *         [Return] - true if an error occurred, false otherwise
+ */
+bool parseNumber(const char *str, unsigned long long *value)
+{
+   char *end;
+
+   *value = strtoull(str, &end, 0x00);
+   if((*str == '\0') ||
+      (*end != '\0'))
+   {
+      return true;
+   }
+
+   return false;
 }
 
 
-/* Output progress of flash write/verify operation.
+/* Output progress of flash write/verify or dump operation.
  *
  * INPUT : [None]
  *
@@ -248,7 +395,7 @@ bool rwDevice(unsigned char *data, unsigned char size, bool read)
    unsigned char rwSize;
    unsigned char *buffer = _buffer;
    unsigned char offset = 0x00;
-   unsigned char attempt = 0x05;
+   unsigned long long deadline;
    bool ret = true;
 
    if((size == 0x00 )||
@@ -270,7 +417,9 @@ bool rwDevice(unsigned char *data, unsigned char size, bool read)
       return true;
    }
 
-   while(attempt--)
+   /*Give the device 5s to complete the roundtrip*/
+   deadline = Platform_GetTimeMS() + 0x1388;
+   while(Platform_GetTimeMS() < deadline)
    {
       /*Fill transfer (USB 1s timeout)*/
       if(read)
@@ -304,13 +453,6 @@ bool rwDevice(unsigned char *data, unsigned char size, bool read)
       /*Check if transfer completed fully*/
       if(rwSize == size)
       {
-         /*Artificially delay write's (to give time for device roundtrip)*/
-         if(!read)
-         {
-            /*200ms delay*/
-            Platform_SleepMS(0xC8);
-         }
-
          ret = false;
          break;
       }
@@ -320,7 +462,8 @@ bool rwDevice(unsigned char *data, unsigned char size, bool read)
          offset += rwSize;
       }
 
-      Platform_Sleep(0x01);
+      /*Device not ready (data still in roundtrip), poll again shortly*/
+      Platform_SleepMS(0x01);
    }
 
    goto done;
@@ -7,9 +7,22 @@
 /******************************************************************************/
 #ifndef POSIX_H
 #define POSIX_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
+#define PLATFORM_THREAD(name, arg) void *name(void *arg)
+#define PLATFORM_THREAD_EXIT (NULL)
+
+typedef pthread_t Platform_Thread;
+typedef void *(*Platform_ThreadRoutine)(void *);
+
 static inline void Platform_Sleep(unsigned int s)
 {
    sleep(s);
@@ -40,6 +53,73 @@ static inline void Platform_SleepNS(unsigned int ns)
 }
 
 
+static inline unsigned long long Platform_GetTimeMS(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (((unsigned long long)ts.tv_sec * 0x03E8) +
+           (ts.tv_nsec / 0x000F4240));
+}
+
+
+static inline bool Platform_MapFile(const char *filename, void **map,
+                                    size_t *size)
+{
+   int fd;
+   struct stat st;
+   bool ret = true;
+
+   fd = open(filename, O_RDONLY);
+   if(fd < 0x00)
+   {
+      return true;
+   }
+
+   if((fstat(fd, &st) == 0x00) &&
+      (st.st_size > 0x00))
+   {
+      *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0x00);
+      if(*map != MAP_FAILED)
+      {
+         *size = (size_t)st.st_size;
+         ret = false;
+      }
+   }
+
+   close(fd);
+   return ret;
+}
+
+
+static inline void Platform_UnmapFile(void *map, size_t size)
+{
+   munmap(map, size);
+}
+
+
+static inline bool Platform_CreateThread(Platform_Thread *thread,
+                                         Platform_ThreadRoutine routine,
+                                         void *arg)
+{
+   return (pthread_create(thread, NULL, routine, arg) != 0x00);
+}
+
+
+static inline void Platform_JoinThread(Platform_Thread thread)
+{
+   pthread_join(thread, NULL);
+}
+
+
+static inline unsigned int Platform_GetProcessorCount(void)
+{
+   long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+   return (count > 0x00) ? (unsigned int)count : 0x01;
+}
+
+
 static inline void Platform_RepeatNS(unsigned int *last, unsigned int ns)
 {
    /*At this resolution (<1000ns) do the full sleep*/
@@ -7,8 +7,16 @@
 /******************************************************************************/
 #ifndef WINDOWS_H
 #define WINDOWS_H
+#include <stdbool.h>
+#include <stddef.h>
 #include <windows.h>
 
+#define PLATFORM_THREAD(name, arg) DWORD WINAPI name(LPVOID arg)
+#define PLATFORM_THREAD_EXIT (0x00)
+
+typedef HANDLE Platform_Thread;
+typedef LPTHREAD_START_ROUTINE Platform_ThreadRoutine;
+
 static inline void Platform_Sleep(unsigned int s)
 {
    Sleep(s * 0x03E8);
@@ -33,6 +41,79 @@ static inline void Platform_SleepNS(unsigned int ns)
 }
 
 
+static inline unsigned long long Platform_GetTimeMS(void)
+{
+   return GetTickCount64();
+}
+
+
+static inline bool Platform_MapFile(const char *filename, void **map,
+                                    size_t *size)
+{
+   HANDLE file;
+   HANDLE mapping;
+   LARGE_INTEGER fileSize;
+   bool ret = true;
+
+   file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+   if(file == INVALID_HANDLE_VALUE)
+   {
+      return true;
+   }
+
+   if((GetFileSizeEx(file, &fileSize)) &&
+      (fileSize.QuadPart > 0x00))
+   {
+      mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0x00, 0x00, NULL);
+      if(mapping != NULL)
+      {
+         *map = MapViewOfFile(mapping, FILE_MAP_READ, 0x00, 0x00, 0x00);
+         if(*map != NULL)
+         {
+            *size = (size_t)fileSize.QuadPart;
+            ret = false;
+         }
+         CloseHandle(mapping);
+      }
+   }
+
+   CloseHandle(file);
+   return ret;
+}
+
+
+static inline void Platform_UnmapFile(void *map, size_t size)
+{
+   UnmapViewOfFile(map);
+}
+
+
+static inline bool Platform_CreateThread(Platform_Thread *thread,
+                                         Platform_ThreadRoutine routine,
+                                         void *arg)
+{
+   *thread = CreateThread(NULL, 0x00, routine, arg, 0x00, NULL);
+   return (*thread == NULL);
+}
+
+
+static inline void Platform_JoinThread(Platform_Thread thread)
+{
+   WaitForSingleObject(thread, INFINITE);
+   CloseHandle(thread);
+}
+
+
+static inline unsigned int Platform_GetProcessorCount(void)
+{
+   SYSTEM_INFO info;
+
+   GetSystemInfo(&info);
+   return (info.dwNumberOfProcessors) ? info.dwNumberOfProcessors : 0x01;
+}
+
+
 static inline void Platform_RepeatNS(unsigned int *last, unsigned int ns)
 {
    /*At this resolution (<1000ns) do the full sleep*/
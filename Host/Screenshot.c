@@ -0,0 +1,198 @@
+/******************************************************************************/
+/*Filename:    Screenshot.c                                                   */
+/*Project:     CNC 1                                                          */
+/*Author:      New Rupture Systems                                            */
+/*Description: Definitions for device display screenshot library utility      */
+/*             functions.                                                     */
+/******************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "BCP.h"
+#include "Screenshot.h"
+
+/*Size of framebuffer (in bytes)*/
+#define FRAME_SIZE ((unsigned long)SCREENSHOT_WIDTH * SCREENSHOT_HEIGHT * 0x02)
+
+
+static bool writeFrame(struct Screenshot_Session *restrict,
+                       const unsigned char *restrict);
+
+
+/* Initialize screenshot library interface (output file is written as binary
+ * PPM).
+ *
+ * INPUT : shot - Screenshot_Session handle
+ *         bcp - BCP_Session handle
+ *         filename - name of output file to create
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool Screenshot_Open(struct Screenshot_Session *restrict shot,
+                     struct BCP_Session *restrict bcp,
+                     const char *restrict filename)
+{
+   shot->file = fopen(filename, "wb");
+   if(shot->file == NULL)
+   {
+      shot->error = 0x00;
+      return true;
+   }
+
+   shot->bcp = bcp;
+   return false;
+}
+
+
+/* Close screenshot library interface.
+ *
+ * INPUT : shot - Screenshot_Session handle
+ *
+ * OUTPUT: [None]
+ */
+void Screenshot_Close(struct Screenshot_Session *restrict shot)
+{
+   fclose(shot->file);
+}
+
+
+/* Retrieve error code for Screenshot_Session.
+ *
+ * INPUT : shot - Screenshot_Session handle
+ *
+ * OUTPUT: [Return] - error code
+ */
+unsigned int Screenshot_GetError(struct Screenshot_Session *restrict shot)
+{
+   return shot->error;
+}
+
+
+/* Retrieve error code string for Screenshot_Session.
+ *
+ * INPUT : shot - Screenshot_Session handle
+ *
+ * OUTPUT: [Return] - error code string
+ */
+const char *Screenshot_GetErrorString(struct Screenshot_Session *restrict shot)
+{
+   const char *lookup[] =
+   {
+      "Unable to create output file",
+      "Unable to allocate frame",
+      "Failed setup for read",
+      "Device Read/Address error (application not running?)",
+      "Unable to write output file"
+   };
+
+   return lookup[shot->error];
+}
+
+
+/* Read device framebuffer into output file. Device address auto-increment is
+ * used so only a single address request is made for the entire frame, reads
+ * the device has not yet captured are retried.
+ *
+ * INPUT : shot - Screenshot_Session handle
+ *         update - callback update function
+ *         rate - rate to call update function (in percent)
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool Screenshot_Read(struct Screenshot_Session *restrict shot,
+                     void (*update)(), const unsigned char rate)
+{
+   unsigned char *frame;
+   unsigned long offset;
+   unsigned char updates = 0x00;
+   bool ret = true;
+
+   frame = malloc(FRAME_SIZE);
+   if(frame == NULL)
+   {
+      shot->error = 0x01;
+      return true;
+   }
+
+   /*Setup*/
+   if((BCP_SetAddress(shot->bcp, SCREENSHOT_ADDRESS)) ||
+      (BCP_SetFlags(shot->bcp, FLAG_ADDR_INC)))
+   {
+      shot->error = 0x02;
+      goto done;
+   }
+
+   for(offset = 0x00; offset < FRAME_SIZE; offset += 0x08)
+   {
+      if(BCP_ReadMemory(shot->bcp, frame + offset, 0x08))
+      {
+         shot->error = 0x03;
+         goto done;
+      }
+
+      if(rate != 0x00)
+      {
+         /*Callback progress update function*/
+         while(updates != ((((offset + 0x08) * 0x64) / FRAME_SIZE) / rate))
+         {
+            update();
+            updates++;
+         }
+      }
+   }
+
+   if(writeFrame(shot, frame))
+   {
+      shot->error = 0x04;
+      goto done;
+   }
+
+   ret = false;
+done:
+   free(frame);
+   return ret;
+}
+
+
+/* Write framebuffer to output file as PPM (top row is highest Y).
+ *
+ * INPUT : shot - Screenshot_Session handle
+ *         frame - framebuffer (RGB565, 16-bit LE)
+ *
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool writeFrame(struct Screenshot_Session *restrict shot,
+                const unsigned char *restrict frame)
+{
+   unsigned char rgb[SCREENSHOT_WIDTH * 0x03];
+   const unsigned char *row;
+   unsigned int colour;
+   unsigned int x;
+   unsigned int y;
+
+   if(fprintf(shot->file, "P6\n%u %u\n255\n", SCREENSHOT_WIDTH,
+              SCREENSHOT_HEIGHT) < 0x00)
+   {
+      return true;
+   }
+
+   for(y = SCREENSHOT_HEIGHT; y--;)
+   {
+      /*Expand RGB565 to RGB888*/
+      row = (frame + (y * SCREENSHOT_WIDTH * 0x02));
+      for(x = 0x00; x < SCREENSHOT_WIDTH; x++)
+      {
+         colour = (row[x * 0x02] | (row[(x * 0x02) + 0x01] << 0x08));
+         rgb[(x * 0x03) + 0x00] = (((colour >> 0x0B) & 0x1F) * 0xFF) / 0x1F;
+         rgb[(x * 0x03) + 0x01] = (((colour >> 0x05) & 0x3F) * 0xFF) / 0x3F;
+         rgb[(x * 0x03) + 0x02] = ((colour & 0x1F) * 0xFF) / 0x1F;
+      }
+
+      if(fwrite(rgb, 0x01, sizeof(rgb), shot->file) != sizeof(rgb))
+      {
+         return true;
+      }
+   }
+
+   return (fflush(shot->file) != 0x00);
+}
@@ -0,0 +1,35 @@
+/******************************************************************************/
+/*Filename:    Screenshot.h                                                   */
+/*Project:     CNC 1                                                          */
+/*Author:      New Rupture Systems                                            */
+/*Description: Device display screenshot (framebuffer read-back) library      */
+/*             utilities.                                                     */
+/******************************************************************************/
+#ifndef SCREENSHOT_H
+#define SCREENSHOT_H
+#include <stdbool.h>
+#include <stdio.h>
+#include "BCP.h"
+
+/*Device framebuffer (BCP bank 0x0001, RGB565 16-bit LE rows from bottom)*/
+#define SCREENSHOT_ADDRESS (0x0001000000000000ULL)
+#define SCREENSHOT_WIDTH   (0x0140)
+#define SCREENSHOT_HEIGHT  (0xF0)
+
+struct Screenshot_Session
+{
+   FILE *file;
+   struct BCP_Session *bcp;
+   unsigned int error;
+};
+
+
+bool Screenshot_Open(struct Screenshot_Session *restrict,
+                     struct BCP_Session *restrict, const char *restrict);
+void Screenshot_Close(struct Screenshot_Session *restrict);
+bool Screenshot_Read(struct Screenshot_Session *restrict, void (*)(),
+                     const unsigned char);
+unsigned int Screenshot_GetError(struct Screenshot_Session *restrict);
+const char *Screenshot_GetErrorString(struct Screenshot_Session *restrict);
+
+#endif
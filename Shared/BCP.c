@@ -47,9 +47,24 @@ union size64
 
 static bool send(struct BCP_Session *restrict);
 static bool receive(struct BCP_Session *restrict);
+static unsigned char seal(struct BCP_Session *restrict);
+static bool checkHeader(struct BCP_Session *restrict);
+static bool checkPacket(struct BCP_Session *restrict);
+#if defined(BCP_HOST)
+static bool seekAddress(struct BCP_Session *restrict, unsigned long long);
+#endif
+#if defined(BCP_DEVICE)
+static void dispatch(struct BCP_Session *restrict,
+                     bool (*)(unsigned long long, void *, unsigned char),
+                     bool (*)(unsigned long long, void *, unsigned char));
+static void advanceAddress(struct BCP_Session *restrict, unsigned char);
+static unsigned long long getAddress(const unsigned char *restrict);
+#endif
 static bool isEvenParity(unsigned char);
 static unsigned char calculateCRC(const unsigned char *restrict, unsigned char);
+#if defined(BCP_HOST)
 static unsigned long long swap64(unsigned long long);
+#endif
 
 
 #if defined(BCP_HOST)
@@ -65,6 +80,8 @@ bool BCP_OpenHost(struct BCP_Session *restrict bcp,
                   bool (*readDevice)(void *, unsigned char),
                   bool (*writeDevice)(void *, unsigned char))
 {
+   bcp->flags = 0x00;
+   bcp->address = 0x00ULL;
    bcp->read = readDevice;
    bcp->write = writeDevice;
 
@@ -116,6 +133,7 @@ bool BCP_SetAddress(struct BCP_Session *restrict bcp,
       return true;
    }
 
+   bcp->address = NTOH64(address);
    return false;
 }
 
@@ -142,6 +160,7 @@ bool BCP_SetFlags(struct BCP_Session *restrict bcp, const unsigned char flags)
       return true;
    }
 
+   bcp->flags = flags;
    return false;
 }
 
@@ -178,6 +197,11 @@ bool BCP_ReadMemory(struct BCP_Session *restrict bcp, void *restrict buffer,
    }
 
    memcpy(buffer, BCP_DATA(bcp), size + 0x01);
+   if(bcp->flags & FLAG_ADDR_INC)
+   {
+      bcp->address += (size + 0x01);
+   }
+
    return false;
 }
 
@@ -212,8 +236,84 @@ bool BCP_WriteMemory(struct BCP_Session *restrict bcp,
       return true;
    }
 
+   if(bcp->flags & FLAG_ADDR_INC)
+   {
+      bcp->address += (size + 0x01);
+   }
+
    return false;
 }
+
+
+/* Fill device memory from current address with a repeating pattern
+ * (written by host in requests of up to 8 bytes).
+ *
+ * INPUT : bcp - BCP session handle
+ *         length - number of bytes to fill
+ *         pattern - pattern to repeat
+ *         patternSize - size of pattern (1-8 bytes)
+ * 
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool BCP_FillMemory(struct BCP_Session *restrict bcp, unsigned int length,
+                    const void *restrict pattern, unsigned char patternSize)
+{
+   unsigned long long address = bcp->address;
+   unsigned char buffer[0x08];
+   unsigned int offset;
+   unsigned char chunk;
+   unsigned char next = 0x00;
+   unsigned char i;
+
+   if((patternSize == 0x00) ||
+      (patternSize > 0x08))
+   {
+      return true;
+   }
+
+   for(offset = 0x00; offset < length; offset += chunk)
+   {
+      chunk = ((length - offset) > 0x08) ? 0x08 :
+                                           (unsigned char)(length - offset);
+      for(i = 0x00; i < chunk; i++)
+      {
+         buffer[i] = ((const unsigned char *)pattern)[next];
+         if(++next == patternSize)
+         {
+            next = 0x00;
+         }
+      }
+
+      if((seekAddress(bcp, address + offset)) ||
+         (BCP_WriteMemory(bcp, buffer, chunk)))
+      {
+         return true;
+      }
+   }
+
+   /*Leave address as a single write would*/
+   return seekAddress(bcp, address +
+                           ((bcp->flags & FLAG_ADDR_INC) ? length : 0x00));
+}
+
+
+/* Set device memory address, unless device is already at that address (as
+ * tracked by session).
+ *
+ * INPUT : bcp - BCP session handle
+ *         address - device memory address to set
+ * 
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool seekAddress(struct BCP_Session *restrict bcp, unsigned long long address)
+{
+   if(bcp->address == address)
+   {
+      return false;
+   }
+
+   return BCP_SetAddress(bcp, address);
+}
 #endif
 
 
@@ -261,85 +361,126 @@ bool BCP_HandleRequest(struct BCP_Session *restrict bcp,
    }
 
    /*Handle request*/
+   dispatch(bcp, reqRead, reqWrite);
+   if(send(bcp))
+   {
+      bcp->error = 0x02;
+      return true;
+   }
+
+   return false;
+}
+
+
+/* Process received request (leaving response in packet, check bits are set
+ * when sealed).
+ *
+ * INPUT : bcp - BCP session handle
+ *         reqRead - callout to handle incoming read requests
+ *         reqWrite - callout to handle incoming write requests
+ * 
+ * OUTPUT: [None]
+ */
+void dispatch(struct BCP_Session *restrict bcp,
+              bool (*reqRead)(unsigned long long, void *, unsigned char),
+              bool (*reqWrite)(unsigned long long, void *, unsigned char))
+{
+   unsigned char *data = BCP_DATA(bcp);
+   unsigned char size = BCP_GET_SIZE(bcp);
+   unsigned char response = RSP_INVALID;
+
    switch(BCP_GET_RR(bcp))
    {
    case REQ_DEVICE_INFO:
-      if(BCP_GET_SIZE(bcp) == 0x00)
+      if((size == 0x00) &&
+         (data[0x00] == PROPERTY_BCP_VERSION))
       {
-         switch(BCP_DATA(bcp)[0x00])
-         {
-         case PROPERTY_BCP_VERSION:
-            BCP_SET_RR(bcp, RSP_DATA);
-            BCP_DATA(bcp)[0x00] = BCP_VERSION_SUPPORTED;
-            goto rspSet;
-         }
+         data[0x00] = BCP_VERSION_SUPPORTED;
+         response = RSP_DATA;
       }
       break;
    case REQ_SET_FLAGS:
-      if(BCP_GET_SIZE(bcp) == 0x00)
+      if(size == 0x00)
       {
          bcp->flags = 0x00;
-         switch(BCP_DATA(bcp)[0x00])
+         if(data[0x00] == FLAG_ADDR_INC)
          {
-         case FLAG_ADDR_INC:
-            bcp->flags |= FLAG_ADDR_INC;
-            BCP_SET_RR(bcp, RSP_NONE);
-            goto rspSet;
+            bcp->flags = FLAG_ADDR_INC;
+            response = RSP_NONE;
          }
       }
       break;
    case REQ_SET_ADDRESS:
-      if(BCP_GET_SIZE(bcp) == 0x07)
+      if(size == 0x07)
       {
-         memcpy(&bcp->address, BCP_DATA(bcp), 0x08);
-         bcp->address = NTOH64(bcp->address);
-         BCP_SET_RR(bcp, RSP_NONE);
-         BCP_SET_SIZE(bcp, 0x00);
-         goto rspSet;
+         bcp->address = getAddress(data);
+         response = RSP_NONE;
       }
       break;
    case REQ_READ_MEMORY:
-      if((BCP_GET_SIZE(bcp) == 0x00) &&
-         (BCP_DATA(bcp)[0x00] < 0x08))
+      if((size == 0x00) &&
+         (data[0x00] < 0x08))
       {
-         BCP_SET_SIZE(bcp, BCP_DATA(bcp)[0x00]);
-         if(!reqRead(bcp->address, BCP_DATA(bcp), (BCP_DATA(bcp)[0x00]) + 0x01))
+         size = data[0x00];
+         if(!reqRead(bcp->address, data, size + 0x01))
          {
-            if(bcp->flags & FLAG_ADDR_INC)
-            {
-               bcp->address += (BCP_GET_SIZE(bcp) + 0x01);
-            }
-            
-            BCP_SET_RR(bcp, RSP_DATA);
-            goto rspSet;
+            advanceAddress(bcp, size + 0x01);
+            response = RSP_DATA;
          }
       }
       break;
    case REQ_WRITE_MEMORY:
-      if(!reqWrite(bcp->address, BCP_DATA(bcp), BCP_GET_SIZE(bcp) + 0x01))
+      if(!reqWrite(bcp->address, data, size + 0x01))
       {
-         if(bcp->flags & FLAG_ADDR_INC)
-         {
-            bcp->address += (BCP_GET_SIZE(bcp) + 0x01);
-         }
-         
-         BCP_SET_RR(bcp, RSP_NONE);
-         BCP_SET_SIZE(bcp, 0x00);
-         goto rspSet;
+         advanceAddress(bcp, size + 0x01);
+         response = RSP_NONE;
       }
       break;
    }
 
-   BCP_SET_RR(bcp, RSP_INVALID);
-   BCP_SET_SIZE(bcp, 0x00);
-rspSet:
-   if(send(bcp))
+   /*Only data responses keep a size*/
+   bcp->pkt[0x00] = (response << 0x05);
+   if(response == RSP_DATA)
    {
-      bcp->error = 0x02;
-      return true;
+      bcp->pkt[0x00] |= size;
    }
+}
 
-   return false;
+
+/* Advance current address past completed access (if auto-increment set).
+ *
+ * INPUT : bcp - BCP session handle
+ *         size - size of access
+ * 
+ * OUTPUT: [None]
+ */
+void advanceAddress(struct BCP_Session *restrict bcp, unsigned char size)
+{
+   if(bcp->flags & FLAG_ADDR_INC)
+   {
+      bcp->address += size;
+   }
+}
+
+
+/* Get address from received big-endian bytes (avoiding 64-bit byte swap on
+ * device).
+ *
+ * INPUT : data - big-endian address bytes
+ * 
+ * OUTPUT: [Return] - address
+ */
+unsigned long long getAddress(const unsigned char *restrict data)
+{
+   unsigned char i;
+   unsigned long long address = 0x00ULL;
+
+   for(i = 0x00; i < 0x08; i++)
+   {
+      address = ((address << 0x08) | data[i]);
+   }
+
+   return address;
 }
 #endif
 
@@ -394,6 +535,50 @@ const char *BCP_GetErrorString(struct BCP_Session *restrict bcp)
  * OUTPUT: [Return] - true if an error occurred, false otherwise
  */
 bool send(struct BCP_Session *restrict bcp)
+{
+   /*Send packet*/
+   if(bcp->write(bcp->pkt, seal(bcp)))
+   {
+      return true;
+   }
+
+   return false;
+}
+
+
+/* Receive request/response.
+ *
+ * INPUT : bcp - BCP session handle
+ * 
+ * OUTPUT: [Return] - true if an error occurred, false otherwise
+ */
+bool receive(struct BCP_Session *restrict bcp)
+{
+   /*Receive packet header*/
+   if((bcp->read(bcp->pkt, 0x01)) ||
+      (checkHeader(bcp)))
+   {
+      return true;
+   }
+
+   /*Receive entire packet*/
+   if((bcp->read(&(bcp->pkt[0x01]), BCP_GET_SIZE(bcp) + 0x02)) ||
+      (checkPacket(bcp)))
+   {
+      return true;
+   }
+
+   return false;
+}
+
+
+/* Set packet check bits and CRC (ready to send).
+ *
+ * INPUT : bcp - BCP session handle
+ * 
+ * OUTPUT: [Return] - size of packet
+ */
+unsigned char seal(struct BCP_Session *restrict bcp)
 {
    unsigned char size = BCP_GET_SIZE(bcp);
 
@@ -410,9 +595,20 @@ bool send(struct BCP_Session *restrict bcp)
    }
 
    bcp->pkt[size + 0x02] = calculateCRC(bcp->pkt, size + 0x02);
+   return (size + 0x03);
+}
 
-   /*Send packet*/
-   if(bcp->write(bcp->pkt, size + 0x03))
+
+/* Check if received packet header is valid.
+ *
+ * INPUT : bcp - BCP session handle
+ * 
+ * OUTPUT: [Return] - true if header is invalid, false otherwise
+ */
+bool checkHeader(struct BCP_Session *restrict bcp)
+{
+   if((isEvenParity(BCP_GET_RR(bcp)) == ((bcp->pkt[0x00]) & 0x10)) ||
+      (isEvenParity(BCP_GET_SIZE(bcp)) == ((bcp->pkt[0x00]) & 0x08)))
    {
       return true;
    }
@@ -421,37 +617,16 @@ bool send(struct BCP_Session *restrict bcp)
 }
 
 
-/* Receive request/response.
+/* Check if entire received packet is valid.
  *
  * INPUT : bcp - BCP session handle
  * 
- * OUTPUT: [Return] - true if an error occurred, false otherwise
+ * OUTPUT: [Return] - true if packet is invalid, false otherwise
  */
-bool receive(struct BCP_Session *restrict bcp)
+bool checkPacket(struct BCP_Session *restrict bcp)
 {
-   unsigned char size;
-
-   /*Receive packet header*/
-   if(bcp->read(bcp->pkt, 0x01))
-   {
-      return true;
-   }
-   
-   /*Check if packet header is valid*/
-   size = BCP_GET_SIZE(bcp);
-   if((isEvenParity(BCP_GET_RR(bcp)) == ((bcp->pkt[0x00]) & 0x10)) ||
-      (isEvenParity(size) == ((bcp->pkt[0x00]) & 0x08)))
-   {
-      return true;
-   }
-
-   /*Receive entire packet*/
-   if(bcp->read(&(bcp->pkt[0x01]), size + 0x02))
-   {
-      return true;
-   }
+   unsigned char size = BCP_GET_SIZE(bcp);
 
-   /*Check if entire packet is valid*/
    if(bcp->pkt[size + 0x02] != calculateCRC(bcp->pkt, size + 0x02))
    {
       return true;
@@ -537,6 +712,7 @@ unsigned char calculateCRC(const unsigned char *restrict data,
 }
 
 
+#if defined(BCP_HOST)
 /* Swap incoming big-endian value to host endianess
  *
  * INPUT : u64 - value to (possibly) swap endianess from
@@ -558,3 +734,4 @@ unsigned long long swap64(unsigned long long u64)
 
    return result.u64;
 }
+#endif
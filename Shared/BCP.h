@@ -78,6 +78,8 @@ bool BCP_ReadMemory(struct BCP_Session *restrict, void *restrict,
                     unsigned char);
 bool BCP_WriteMemory(struct BCP_Session *restrict, const void *restrict,
                      unsigned char);
+bool BCP_FillMemory(struct BCP_Session *restrict, unsigned int,
+                    const void *restrict, unsigned char);
 #endif
 
 #if defined(BCP_DEVICE)
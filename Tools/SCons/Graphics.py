@@ -0,0 +1,164 @@
+################################################################################
+# Filename:    Graphics.py                                                     #
+# License:     Public Domain                                                   #
+# Author:      New Rupture Systems                                             #
+# Description: Defines builders generating ROM graphics data (glyph run table  #
+#              and RLE RGB565 images) for the ATmega324 application.           #
+################################################################################
+import os
+import re
+from SCons.Script import *
+
+
+# Format values as rows of a C byte array initializer
+def format_table(values, indent):
+   lines = []
+   for i in range(0, len(values), 0x08):
+      lines.append(indent + ", ".join("0x{0:02X}".format(v)
+                                      for v in values[i:i + 0x08]))
+   return ",\n".join(lines)
+
+
+# Generate glyph row run table (from 8x12 font bitmap)
+def make_char_runs(target, source, env):
+   text = source[0].get_text_contents()
+   text = text[text.index("CharMap_Bitmap[] ="):]
+   bitmap = [int(x, 16) for x in re.findall(r"0x([0-9A-Fa-f]{2})", text)]
+
+   # Each distinct row is encoded as up to 8 nibble runs (MSB first), each
+   # run being a colour bit (1 = foreground) and length - 1 (3-bit)
+   rows = sorted(set(bitmap))
+   runs = []
+   for row in rows:
+      nibbles = []
+      bit = 0x07
+      while bit >= 0:
+         colour = (row >> bit) & 0x01
+         length = 0
+         while (bit >= 0) and (((row >> bit) & 0x01) == colour):
+            length += 1
+            bit -= 1
+         nibbles.append((colour << 0x03) | (length - 1))
+      nibbles.extend([0x00] * (0x08 - len(nibbles)))
+      runs.append([(nibbles[i] << 0x04) | nibbles[i + 1]
+                   for i in range(0, 0x08, 0x02)])
+
+   with open(target[0].get_abspath(), "w") as f:
+      f.write("/*Generated from CharMap.h (see Graphics.py), do not edit*/\n"
+              "#ifndef CHAR_RUNS_H\n"
+              "#define CHAR_RUNS_H\n"
+              "#include \"Platform.h\"\n"
+              "\n"
+              "#define CHAR_RUNS_SIZE (0x04)\n"
+              "\n"
+              "/*Store data in program memory on AVR*/\n"
+              "#if PLATFORM_ARCH == PLATFORM_AVR\n"
+              "#include <avr/pgmspace.h>\n"
+              "#define CHAR_RUNS_ROM PROGMEM\n"
+              "#else\n"
+              "#define CHAR_RUNS_ROM\n"
+              "#endif\n"
+              "\n"
+              "/*Run table entry for each glyph row (CharMap_Bitmap layout)*/\n"
+              "const unsigned char CharRuns_Index[] CHAR_RUNS_ROM =\n"
+              "{\n" + format_table([rows.index(b) for b in bitmap], "   ") +
+              "\n};\n"
+              "\n"
+              "/*Runs for each distinct glyph row*/\n"
+              "const unsigned char CharRuns_Runs[][CHAR_RUNS_SIZE] "
+              "CHAR_RUNS_ROM =\n"
+              "{\n" + ",\n".join("   {" + format_table(r, "") + "}"
+                                  for r in runs) +
+              "\n};\n"
+              "#endif\n")
+
+# Generate RLE RGB565 images (for SSD1289_DrawImage()) from XPM icons
+def make_icons(target, source, env):
+   output = ("/*Generated from Icons/ XPM files (see Graphics.py), do not "
+             "edit*/\n"
+             "#ifndef ICONS_H\n"
+             "#define ICONS_H\n"
+             "#include \"Platform.h\"\n"
+             "\n"
+             "/*Store data in program memory on AVR*/\n"
+             "#if PLATFORM_ARCH == PLATFORM_AVR\n"
+             "#include <avr/pgmspace.h>\n"
+             "#define ICONS_ROM PROGMEM\n"
+             "#else\n"
+             "#define ICONS_ROM\n"
+             "#endif\n")
+
+   for icon in source:
+      # XPM: "<width> <height> <colours> <chars per pixel>", colours, pixels
+      lines = re.findall(r"\"([^\"]*)\"", icon.get_text_contents())
+      width, height, count, cpp = [int(x) for x in lines[0].split()[:4]]
+      if (width > 0x0140) or (height > 0xF0):
+         raise Exception("{0}: image too large".format(icon))
+
+      palette = {}
+      for line in lines[1:count + 1]:
+         value = line[cpp:].split()[-1]
+         if value.lower() == "none":
+            palette[line[:cpp]] = None
+         else:
+            rgb = int(value.lstrip("#"), 16)
+            palette[line[:cpp]] = (((rgb >> 0x08) & 0xF800) |
+                                   ((rgb >> 0x05) & 0x07E0) |
+                                   ((rgb >> 0x03) & 0x001F))
+
+      # Display Y increases upwards, therefore store bottom row first
+      pixels = []
+      for line in reversed(lines[count + 1:count + 1 + height]):
+         pixels.extend(palette[line[i:i + cpp]]
+                       for i in range(0, width * cpp, cpp))
+
+      # Header: width (16-bit LE), height (8-bit), then tokens:
+      # 0x00-0x7F: run of n + 1 pixels of following colour (16-bit LE)
+      # 0x80-0xBF: (n & 0x3F) + 1 literal pixels follow (16-bit LE each)
+      # 0xC0-0xFF: run of (n & 0x3F) + 1 background (transparent) pixels
+      data = [width & 0xFF, width >> 0x08, height]
+      literal = None
+      i = 0
+      while i < len(pixels):
+         run = 1
+         while ((i + run) < len(pixels)) and (run < 0x80) and \
+               (pixels[i + run] == pixels[i]):
+            run += 1
+
+         if pixels[i] is None:
+            run = min(run, 0x40)
+            data.append(0xC0 | (run - 1))
+            literal = None
+         elif run > 1:
+            data.extend([run - 1, pixels[i] & 0xFF, pixels[i] >> 0x08])
+            literal = None
+         else:
+            if (literal is None) or (data[literal] == 0xBF):
+               literal = len(data)
+               data.append(0x80)
+            else:
+               data[literal] += 1
+            data.extend([pixels[i] & 0xFF, pixels[i] >> 0x08])
+         i += run
+
+      name = os.path.splitext(os.path.basename(str(icon)))[0]
+      output += ("\n"
+                 "/*{0} ({1}x{2})*/\n"
+                 "const unsigned char Icon_{0}[] ICONS_ROM =\n"
+                 "{{\n{3}\n}};\n").format(name, width, height,
+                                          format_table(data, "   "))
+
+   with open(target[0].get_abspath(), "w") as f:
+      f.write(output + "#endif\n")
+
+
+def generate(env):
+   env.Append(BUILDERS =
+              {"CharRuns" : Builder(action = Action(make_char_runs,
+                                                    cmdstr = "Making $TARGET")),
+               "Icons" : Builder(action = Action(make_icons,
+                                                 cmdstr = "Making $TARGET"))})
+
+
+def exists(env):
+   return True